@@ -0,0 +1,14 @@
+#version 450
+
+// One fixed directional light, enough to tell the objects apart
+
+layout(location = 0) in vec3 inNormal;
+
+layout(location = 0) out vec4 outColour;
+
+void main()
+{
+    const vec3 light = normalize(vec3(0.4, 1.0, 0.3));
+    const float diffuse = max(dot(normalize(inNormal), light), 0.0);
+    outColour = vec4(vec3(0.15 + 0.85 * diffuse), 1.0);
+}
@@ -0,0 +1,31 @@
+#version 450
+
+// GpuScene objects, the cull shader puts each draw's object index in firstInstance
+
+struct Object
+{
+    mat4 transform;
+    vec4 sphere;
+    uint mesh;
+    uint material;
+    uint padding[2];
+};
+
+layout(set = 0, binding = 0) readonly buffer Objects { Object objects[]; };
+
+layout(push_constant) uniform Constants
+{
+    mat4 viewProjection;
+};
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+
+layout(location = 0) out vec3 outNormal;
+
+void main()
+{
+    const mat4 model = objects[gl_InstanceIndex].transform;
+    outNormal = mat3(model) * inNormal;
+    gl_Position = viewProjection * model * vec4(inPosition, 1.0);
+}
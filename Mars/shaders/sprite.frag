@@ -0,0 +1,39 @@
+#version 450
+
+// Samples the quad's slot of the batch's texture array and applies the tint
+
+layout(set = 0, binding = 0) uniform sampler2D textures[16];
+
+layout(location = 0) in vec2 inUV;
+layout(location = 1) in vec4 inColour;
+layout(location = 2) flat in uint inTexture;
+
+layout(location = 0) out vec4 outColour;
+
+void main()
+{
+    // The slot varies inside a draw, which plain sampler array indexing does not allow
+    vec4 texel;
+
+    switch (inTexture)
+    {
+        case 0: texel = texture(textures[0], inUV); break;
+        case 1: texel = texture(textures[1], inUV); break;
+        case 2: texel = texture(textures[2], inUV); break;
+        case 3: texel = texture(textures[3], inUV); break;
+        case 4: texel = texture(textures[4], inUV); break;
+        case 5: texel = texture(textures[5], inUV); break;
+        case 6: texel = texture(textures[6], inUV); break;
+        case 7: texel = texture(textures[7], inUV); break;
+        case 8: texel = texture(textures[8], inUV); break;
+        case 9: texel = texture(textures[9], inUV); break;
+        case 10: texel = texture(textures[10], inUV); break;
+        case 11: texel = texture(textures[11], inUV); break;
+        case 12: texel = texture(textures[12], inUV); break;
+        case 13: texel = texture(textures[13], inUV); break;
+        case 14: texel = texture(textures[14], inUV); break;
+        default: texel = texture(textures[15], inUV); break;
+    }
+
+    outColour = texel * inColour;
+}
@@ -0,0 +1,25 @@
+#version 450
+
+// Renderer2D quads, the view projection comes in as a push constant
+
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec2 inUV;
+layout(location = 2) in vec4 inColour;
+layout(location = 3) in uint inTexture;
+
+layout(push_constant) uniform Constants
+{
+    mat4 viewProjection;
+};
+
+layout(location = 0) out vec2 outUV;
+layout(location = 1) out vec4 outColour;
+layout(location = 2) flat out uint outTexture;
+
+void main()
+{
+    outUV = inUV;
+    outColour = inColour;
+    outTexture = inTexture;
+    gl_Position = viewProjection * vec4(inPosition, 0.0, 1.0);
+}
@@ -6,7 +6,7 @@
 
 namespace Mars
 {
-    Application::Application(const ApplicationSpecifications &specs): running(true)
+    Application::Application(const ApplicationSpecifications &specs): window(nullptr), running(true)
     {
         if(!glfwInit())
         {
@@ -17,7 +17,17 @@ namespace Mars
 
         std::cout << "Created " << specs.name << std::endl;
 
+        // Vulkan renders into the window, GLFW must not create an OpenGL context for it
+        glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
         window = glfwCreateWindow(specs.width, specs.height, specs.name.data(), nullptr, nullptr);
+
+        if (window == nullptr)
+        {
+            std::cout << "Error, could not create window!" << std::endl;
+            running = false;
+            return;
+        }
+
         glfwSetWindowUserPointer(window, this);
 
         glfwSetWindowSizeCallback(window, [](GLFWwindow *window, int width, int height){
@@ -82,26 +92,36 @@ namespace Mars
             data->onEvent(event);
         });
 
-        Renderer::Init();
+        Renderer::Init(window, specs.gpu);
     }
 
     Application::~Application()
     {
-        Renderer::Shutdown();
-        glfwDestroyWindow(window);
+        // The renderer only exists once the window does
+        if (window != nullptr)
+        {
+            Renderer::Shutdown();
+            glfwDestroyWindow(window);
+        }
+
         glfwTerminate();
     }
 
     void Application::run()
     {
+        auto lastTime = float(glfwGetTime());
+
         while(running)
         {
             glfwPollEvents();
-            const float timestep = glfwGetTime();
+            const auto time = float(glfwGetTime());
+            const float timestep = time - lastTime;
+            lastTime = time;
 
             // TODO: Update UI
 
             Renderer::BeginRender();
+            onUpdate(timestep);
             Renderer::EndRender();
         }
     }
@@ -6,7 +6,7 @@
 
 #include "Base.hpp"
 #include <GLFW/glfw3.h>
-#include "../Renderer/Renderer.hpp"
+#include "../Renderer/RenderCommand.hpp"
 
 namespace Mars
 {
@@ -14,17 +14,22 @@ namespace Mars
     {
         std::string_view name;
         int32_t width, height;
+        std::string_view gpu;   // GPU index or part of its name, empty picks the best one. MARS_GPU overrides it
     };
 
     class Application
     {
     public:
         explicit Application(const ApplicationSpecifications &specs);
-        ~Application();
+        virtual ~Application();
 
         void run();
         void onEvent(Event &event);
 
+    protected:
+        // Called every frame between Renderer::BeginRender and EndRender, timestep in seconds
+        virtual void onUpdate(float timestep) {}
+
     private:
         GLFWwindow *window;
         bool running;
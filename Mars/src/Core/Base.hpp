@@ -5,6 +5,7 @@
 #pragma once
 
 #include "../Utilities/math_matrix.hpp"
+#include "../Utilities/math_utils.hpp"
 #include "Events.hpp"
 
 #include <string>
@@ -0,0 +1,79 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#include "JobSystem.hpp"
+
+namespace Mars
+{
+    void JobSystem::initialise(uint32_t threadCount)
+    {
+        if (threadCount == 0)
+            threadCount = max(std::thread::hardware_concurrency(), 2u) - 1;
+
+        active = 0;
+        running = true;
+
+        for (uint32_t i = 0; i < threadCount; i++)
+            workers.emplace_back([this]{ workerLoop(); });
+    }
+
+    void JobSystem::shutdown()
+    {
+        {
+            std::lock_guard lock(mutex);
+            running = false;
+        }
+
+        wake.notify_all();
+
+        for (auto &worker : workers)
+            worker.join();
+
+        workers.clear();
+        jobs.clear();
+    }
+
+    void JobSystem::submit(std::function<void()> job)
+    {
+        {
+            std::lock_guard lock(mutex);
+            jobs.push_back(std::move(job));
+        }
+
+        wake.notify_one();
+    }
+
+    void JobSystem::wait()
+    {
+        std::unique_lock lock(mutex);
+        idle.wait(lock, [this]{ return jobs.empty() && active == 0; });
+    }
+
+    void JobSystem::workerLoop()
+    {
+        std::unique_lock lock(mutex);
+
+        while (true)
+        {
+            wake.wait(lock, [this]{ return !jobs.empty() || !running; });
+
+            // Pending jobs are still drained on shutdown so nothing waiting on them hangs
+            if (jobs.empty())
+                return;
+
+            auto job = std::move(jobs.front());
+            jobs.pop_front();
+            active++;
+
+            lock.unlock();
+            job();
+            lock.lock();
+
+            active--;
+
+            if (jobs.empty() && active == 0)
+                idle.notify_all();
+        }
+    }
+}
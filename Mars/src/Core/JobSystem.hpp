@@ -0,0 +1,43 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#pragma once
+
+#include "Base.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace Mars
+{
+    // Fixed pool of worker threads draining a shared FIFO of jobs
+    class JobSystem
+    {
+    public:
+        // Zero uses every hardware thread but the calling one
+        void initialise(uint32_t threadCount = 0);
+        void shutdown();
+
+        void submit(std::function<void()> job);
+
+        // Blocks until the queue is empty and every worker is idle, never returns when called from a job
+        void wait();
+
+        uint32_t workerCount() const { return uint32_t(workers.size()); }
+
+    private:
+        void workerLoop();
+
+        std::vector<std::thread>            workers;
+        std::deque<std::function<void()>>   jobs;
+        std::mutex                          mutex;
+        std::condition_variable             wake;
+        std::condition_variable             idle;
+        uint32_t                            active;
+        bool                                running;
+    };
+}
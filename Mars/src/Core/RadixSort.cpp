@@ -0,0 +1,243 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#include "RadixSort.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+
+namespace Mars
+{
+    static inline uint32_t Digit(uint64_t key, uint32_t pass)
+    {
+        return uint32_t(key >> (pass * RadixSorter::DigitBits)) & (RadixSorter::Buckets - 1);
+    }
+
+    void RadixSorter::initialise(JobSystem *jobSystem)
+    {
+        jobs = jobSystem;
+        stats = {};
+    }
+
+    void RadixSorter::sort(SortKey *keys, SortKey *scratch, size_t count)
+    {
+        const auto result = sortKeys(keys, scratch, count);
+
+        if (result != keys)
+            std::memcpy(keys, result, count * sizeof(SortKey));
+    }
+
+    void RadixSorter::sort(std::vector<SortKey> &keys)
+    {
+        if (scratchBuffer.size() < keys.size())
+            scratchBuffer.resize(keys.size());
+
+        const auto result = sortKeys(keys.data(), scratchBuffer.data(), keys.size());
+
+        if (result != keys.data())
+        {
+            scratchBuffer.resize(keys.size());
+            keys.swap(scratchBuffer);
+        }
+    }
+
+    SortKey *RadixSorter::sortKeys(SortKey *keys, SortKey *scratch, size_t count)
+    {
+        stats = {};
+        stats.tasks = 1;
+
+        if (count <= SmallThreshold)
+        {
+            std::stable_sort(keys, keys + count, [](const SortKey &a, const SortKey &b){ return a.key < b.key; });
+            return keys;
+        }
+
+        const auto workers = jobs != nullptr ? jobs->workerCount() : 0;
+
+        if (count < ParallelThreshold || workers == 0)
+            return sortSerial(keys, scratch, count);
+
+        // The calling thread takes a range too
+        const auto tasks = uint32_t(min(size_t(workers) + 1, count / MinKeysPerTask));
+        return sortParallel(keys, scratch, count, tasks);
+    }
+
+    SortKey *RadixSorter::sortSerial(SortKey *keys, SortKey *scratch, size_t count)
+    {
+        histograms.assign(Passes * Buckets, 0);
+        countDigits(keys, count, histograms.data());
+
+        auto src = keys;
+        auto dst = scratch;
+
+        // Bucket totals do not depend on order, the counts of the first read serve every pass
+        for (uint32_t pass = 0; pass < Passes; pass++)
+        {
+            const auto histogram = histograms.data() + pass * Buckets;
+
+            if (constantDigit(histogram, count))
+            {
+                stats.skippedPasses++;
+                continue;
+            }
+
+            uint32_t bucketOffsets[Buckets];
+            uint32_t sum = 0;
+
+            for (uint32_t bucket = 0; bucket < Buckets; bucket++)
+            {
+                bucketOffsets[bucket] = sum;
+                sum += histogram[bucket];
+            }
+
+            for (size_t i = 0; i < count; i++)
+                dst[bucketOffsets[Digit(src[i].key, pass)]++] = src[i];
+
+            std::swap(src, dst);
+            stats.passes++;
+        }
+
+        return src;
+    }
+
+    SortKey *RadixSorter::sortParallel(SortKey *keys, SortKey *scratch, size_t count, uint32_t tasks)
+    {
+        stats.tasks = tasks;
+        histograms.assign(size_t(tasks) * Passes * Buckets, 0);
+        offsets.resize(size_t(tasks) * Buckets);
+
+        const auto rangeBegin = [count, tasks](uint32_t task){ return count * task / tasks; };
+
+        runTasks(tasks, [&](uint32_t task)
+        {
+            const auto first = rangeBegin(task);
+            countDigits(keys + first, rangeBegin(task + 1) - first, histograms.data() + size_t(task) * Passes * Buckets);
+        });
+
+        // Totals over all tasks decide which passes can be skipped
+        uint32_t totals[Passes][Buckets];
+
+        for (uint32_t pass = 0; pass < Passes; pass++)
+        {
+            for (uint32_t bucket = 0; bucket < Buckets; bucket++)
+            {
+                uint32_t sum = 0;
+
+                for (uint32_t task = 0; task < tasks; task++)
+                    sum += histograms[(size_t(task) * Passes + pass) * Buckets + bucket];
+
+                totals[pass][bucket] = sum;
+            }
+        }
+
+        auto src = keys;
+        auto dst = scratch;
+
+        for (uint32_t pass = 0; pass < Passes; pass++)
+        {
+            if (constantDigit(totals[pass], count))
+            {
+                stats.skippedPasses++;
+                continue;
+            }
+
+            // After the first scatter every task's range holds different keys and has to be counted again
+            if (stats.passes > 0)
+            {
+                runTasks(tasks, [&](uint32_t task)
+                {
+                    auto histogram = histograms.data() + (size_t(task) * Passes + pass) * Buckets;
+                    std::fill(histogram, histogram + Buckets, 0u);
+
+                    for (size_t i = rangeBegin(task); i < rangeBegin(task + 1); i++)
+                        histogram[Digit(src[i].key, pass)]++;
+                });
+            }
+
+            // Bucket major, task minor: lower tasks write first within a bucket, which keeps the sort stable
+            uint32_t sum = 0;
+
+            for (uint32_t bucket = 0; bucket < Buckets; bucket++)
+            {
+                for (uint32_t task = 0; task < tasks; task++)
+                {
+                    offsets[size_t(task) * Buckets + bucket] = sum;
+                    sum += histograms[(size_t(task) * Passes + pass) * Buckets + bucket];
+                }
+            }
+
+            runTasks(tasks, [&](uint32_t task)
+            {
+                auto taskOffsets = offsets.data() + size_t(task) * Buckets;
+
+                for (size_t i = rangeBegin(task); i < rangeBegin(task + 1); i++)
+                    dst[taskOffsets[Digit(src[i].key, pass)]++] = src[i];
+            });
+
+            std::swap(src, dst);
+            stats.passes++;
+        }
+
+        return src;
+    }
+
+    template<typename F>
+    void RadixSorter::runTasks(uint32_t tasks, F &&task)
+    {
+        // Waiting on the whole job system would never return when the sort runs on one of its workers.
+        // Tasks are claimed instead, so the caller finishes them alone if no worker is free, and jobs
+        // that start after the last claim return without touching task.
+        struct Progress
+        {
+            std::atomic<uint32_t>   next{ 0 };
+            std::atomic<uint32_t>   done{ 0 };
+        };
+
+        const auto progress = std::make_shared<Progress>();
+
+        const auto claim = [progress, tasks, &task]
+        {
+            for (auto i = progress->next++; i < tasks; i = progress->next++)
+            {
+                task(i);
+
+                if (++progress->done == tasks)
+                    progress->done.notify_all();
+            }
+        };
+
+        for (uint32_t i = 1; i < tasks; i++)
+            jobs->submit(claim);
+
+        claim();
+
+        for (auto done = progress->done.load(); done < tasks; done = progress->done.load())
+            progress->done.wait(done);
+    }
+
+    void RadixSorter::countDigits(const SortKey *keys, size_t count, uint32_t *histograms)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            const auto key = keys[i].key;
+
+            for (uint32_t pass = 0; pass < Passes; pass++)
+                histograms[pass * Buckets + Digit(key, pass)]++;
+        }
+    }
+
+    bool RadixSorter::constantDigit(const uint32_t *histogram, size_t count)
+    {
+        // Every key in one bucket, scattering would only copy
+        for (uint32_t bucket = 0; bucket < Buckets; bucket++)
+        {
+            if (histogram[bucket] != 0)
+                return histogram[bucket] == count;
+        }
+
+        return true;
+    }
+}
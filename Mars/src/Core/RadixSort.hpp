@@ -0,0 +1,73 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#pragma once
+
+#include "JobSystem.hpp"
+
+namespace Mars
+{
+    // A 64-bit sort key and the index of whatever it was computed for
+    struct SortKey
+    {
+        uint64_t    key;
+        uint32_t    index;
+    };
+
+    // Stable LSD radix sort on SortKey::key, 11 bits per pass. One read over the input counts the digits of
+    // every pass up front, passes whose digit is the same for all keys are skipped entirely, which is most
+    // of them for keys packing a few small fields. Inputs of at least ParallelThreshold keys are counted and
+    // scattered on the job system's workers as well as the calling thread, each worker owning a contiguous
+    // range and writing through its own per-bucket offsets.
+    //
+    // The sort only waits for its own tasks, so the job system may be shared and sort() may run on one of
+    // its workers. Queued unrelated work delays the workers' share, the calling thread takes it over then.
+    class RadixSorter
+    {
+    public:
+        static constexpr uint32_t DigitBits = 11;
+        static constexpr uint32_t Buckets = 1u << DigitBits;
+        static constexpr uint32_t Passes = (64 + DigitBits - 1) / DigitBits;
+        static constexpr size_t SmallThreshold = 256;           // Comparison sort below
+        static constexpr size_t ParallelThreshold = 65536;
+        static constexpr size_t MinKeysPerTask = 16384;
+
+        struct Stats
+        {
+            uint32_t    passes;             // Scatter passes run by the last sort
+            uint32_t    skippedPasses;
+            uint32_t    tasks;              // Threads the last sort was split across
+        };
+
+        // Sorts on the calling thread only without a job system
+        void initialise(JobSystem *jobSystem = nullptr);
+
+        // scratch has room for count keys, the result always ends up in keys
+        void sort(SortKey *keys, SortKey *scratch, size_t count);
+
+        // Uses an internal scratch buffer that is kept between calls. Odd pass counts swap the
+        // vectors instead of copying back, keys may come back with the scratch buffer's storage.
+        void sort(std::vector<SortKey> &keys);
+
+        const Stats &getStats() const { return stats; }
+
+    private:
+        // Returns the buffer the sorted keys ended up in
+        SortKey *sortKeys(SortKey *keys, SortKey *scratch, size_t count);
+        SortKey *sortSerial(SortKey *keys, SortKey *scratch, size_t count);
+        SortKey *sortParallel(SortKey *keys, SortKey *scratch, size_t count, uint32_t tasks);
+
+        template<typename F>
+        void runTasks(uint32_t tasks, F &&task);
+
+        static void countDigits(const SortKey *keys, size_t count, uint32_t *histograms);
+        static bool constantDigit(const uint32_t *histogram, size_t count);
+
+        JobSystem               *jobs;
+        std::vector<SortKey>    scratchBuffer;
+        std::vector<uint32_t>   histograms;     // Passes * Buckets per task
+        std::vector<uint32_t>   offsets;        // Buckets per task
+        Stats                   stats;
+    };
+}
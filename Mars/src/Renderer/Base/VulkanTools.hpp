@@ -10,7 +10,8 @@ namespace vks::Tools
 {
 #define TOOLS_API inline
 
-    TOOLS_API VkSampleCountFlagBits SampleCount(VkPhysicalDevice gpu)
+    // Highest sample count supported for both colour and depth, up to maxSamples
+    TOOLS_API VkSampleCountFlagBits SampleCount(VkPhysicalDevice gpu, VkSampleCountFlagBits maxSamples = VK_SAMPLE_COUNT_64_BIT)
     {
         VkPhysicalDeviceProperties props{};
         vkGetPhysicalDeviceProperties(gpu, &props);
@@ -19,7 +20,7 @@ namespace vks::Tools
                              props.limits.framebufferColorSampleCounts;
 
         auto sampleCount = VK_SAMPLE_COUNT_1_BIT;
-        for (uint32_t bit = VK_SAMPLE_COUNT_64_BIT; bit != VK_SAMPLE_COUNT_1_BIT; bit >>= 1)
+        for (uint32_t bit = maxSamples; bit > VK_SAMPLE_COUNT_1_BIT; bit >>= 1)
         {
             if (samples & bit)
             {
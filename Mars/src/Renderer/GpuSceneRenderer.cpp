@@ -0,0 +1,143 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#include "GpuSceneRenderer.hpp"
+
+#include <cmath>
+#include <cstring>
+
+namespace Mars
+{
+    bool GpuSceneRenderer::initialise(vks::VulkanDevice *dev,
+                                      uint32_t frameCount,
+                                      VkShaderModule cullShader,
+                                      uint32_t maxObjects,
+                                      vks::DescriptorLayoutCache *layoutCache)
+    {
+        device = dev;
+        vertexCount = 0;
+        indexCount = 0;
+        scenePipeline = VK_NULL_HANDLE;
+        pipelineLayout = VK_NULL_HANDLE;
+        camera = mat4x4::identity();
+
+        if (cullShader == VK_NULL_HANDLE)
+        {
+            std::cout << "Warning, gpu_cull.comp is not in the shader archive" << std::endl;
+            return false;
+        }
+
+        if (!scene.initialise(device, cullShader, frameCount, maxObjects))
+            return false;
+
+        vertices.create(device, MaxVertices * sizeof(SceneVertex), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        indices.create(device, MaxIndices * sizeof(uint32_t), VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        const VkDescriptorSetLayoutBinding bindings[] = {
+                vks::Inits::descriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT)
+        };
+
+        setLayout = layoutCache->getLayout(bindings);
+
+        // The sets live as long as the scene, they do not come from the per-frame allocator
+        const VkDescriptorPoolSize poolSizes[] = {
+                vks::Inits::descriptorPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, frameCount)
+        };
+
+        const auto poolInfo = vks::Inits::descriptorPoolCreateInfo(poolSizes, frameCount);
+        vkCreateDescriptorPool(*device, &poolInfo, nullptr, &descriptorPool);
+
+        for (uint32_t i = 0; i < frameCount; i++)
+        {
+            const auto allocInfo = vks::Inits::descriptorSetAllocateInfo(descriptorPool, &setLayout, 1);
+            vkAllocateDescriptorSets(*device, &allocInfo, &sets[i]);
+
+            const auto bufferInfo = vks::Inits::descriptorBufferInfo(scene.getObjectBuffer(i), 0, VK_WHOLE_SIZE);
+            const auto write = vks::Inits::writeDescriptorSet(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, sets[i], &bufferInfo);
+            vkUpdateDescriptorSets(*device, 1, &write, 0, nullptr);
+        }
+
+        ready = true;
+        return true;
+    }
+
+    void GpuSceneRenderer::shutdown()
+    {
+        if (!ready)
+            return;
+
+        scene.shutdown();
+        vertices.destroy();
+        indices.destroy();
+        device->deletionQueue.push(descriptorPool);
+        ready = false;
+    }
+
+    void GpuSceneRenderer::setPipeline(VkPipeline pipeline, VkPipelineLayout layout)
+    {
+        scenePipeline = pipeline;
+        pipelineLayout = layout;
+    }
+
+    uint32_t GpuSceneRenderer::addMesh(const SceneVertex *meshVertices,
+                                       uint32_t meshVertexCount,
+                                       const uint32_t *meshIndices,
+                                       uint32_t meshIndexCount)
+    {
+        if (!ready || vertexCount + meshVertexCount > MaxVertices || indexCount + meshIndexCount > MaxIndices)
+        {
+            std::cout << "Warning, GPU scene geometry buffers are full" << std::endl;
+            return UINT32_MAX;
+        }
+
+        float radiusSquared = 0.0f;
+
+        for (uint32_t i = 0; i < meshVertexCount; i++)
+        {
+            const auto &position = meshVertices[i].position;
+            radiusSquared = max(radiusSquared, position[0] * position[0] + position[1] * position[1] + position[2] * position[2]);
+        }
+
+        // Frames in flight only read the ranges of earlier meshes, appending needs no wait
+        std::memcpy(vertices.data<SceneVertex>() + vertexCount, meshVertices, meshVertexCount * sizeof(SceneVertex));
+        std::memcpy(indices.data<uint32_t>() + indexCount, meshIndices, meshIndexCount * sizeof(uint32_t));
+        vertices.flush(vertexCount * sizeof(SceneVertex), meshVertexCount * sizeof(SceneVertex));
+        indices.flush(indexCount * sizeof(uint32_t), meshIndexCount * sizeof(uint32_t));
+
+        vks::GpuMesh mesh{};
+        mesh.indexCount = meshIndexCount;
+        mesh.firstIndex = indexCount;
+        mesh.vertexOffset = int32_t(vertexCount);
+        mesh.radius = std::sqrt(radiusSquared);
+
+        vertexCount += meshVertexCount;
+        indexCount += meshIndexCount;
+        return scene.addMesh(mesh);
+    }
+
+    void GpuSceneRenderer::cull(VkCommandBuffer command, uint32_t frame)
+    {
+        if (ready)
+            scene.cull(command, frame, camera);
+    }
+
+    void GpuSceneRenderer::draw(VkCommandBuffer command, uint32_t frame)
+    {
+        if (!ready || scenePipeline == VK_NULL_HANDLE)
+            return;
+
+        vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_GRAPHICS, scenePipeline);
+        vkCmdBindDescriptorSets(command, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &sets[frame], 0, nullptr);
+        vkCmdPushConstants(command, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(mat4x4), &camera);
+
+        const VkBuffer vertexBuffers[] = { vertices };
+        const VkDeviceSize offsets[] = { 0 };
+        vkCmdBindVertexBuffers(command, 0, 1, vertexBuffers, offsets);
+        vkCmdBindIndexBuffer(command, indices, 0, VK_INDEX_TYPE_UINT32);
+
+        scene.draw(command, frame);
+    }
+}
@@ -0,0 +1,79 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#pragma once
+
+#include "VulkanDescriptors.hpp"
+#include "VulkanGpuScene.hpp"
+
+#include <cstddef>
+
+namespace Mars
+{
+    struct SceneVertex
+    {
+        float       position[3];
+        float       normal[3];
+    };
+
+    // Owns a vks::GpuScene together with the shared vertex and index buffers its meshes live in and
+    // the per-frame sets exposing the object buffer to the vertex shader. cull() and draw() do nothing
+    // until initialise succeeded, so the scene costs nothing for applications that never use it.
+    //
+    // Pipelines are created against getSetLayout() at set 0, a vertex stage push constant holding the
+    // view projection matrix and VertexAttributes at binding 0, see shaders/scene.vert and scene.frag.
+    class GpuSceneRenderer
+    {
+    public:
+        static constexpr uint32_t MaxVertices = 1u << 18;
+        static constexpr uint32_t MaxIndices = 1u << 20;
+
+        static constexpr VkVertexInputAttributeDescription VertexAttributes[] = {
+                { 0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(SceneVertex, position) },
+                { 1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(SceneVertex, normal) }
+        };
+
+        // False when the device cannot draw a GpuScene or cullShader is missing
+        bool initialise(vks::VulkanDevice *dev,
+                        uint32_t frameCount,
+                        VkShaderModule cullShader,
+                        uint32_t maxObjects,
+                        vks::DescriptorLayoutCache *layoutCache);
+        void shutdown();
+
+        bool isReady() const { return ready; }
+
+        void setPipeline(VkPipeline pipeline, VkPipelineLayout layout);
+        VkDescriptorSetLayout getSetLayout() const { return setLayout; }
+
+        // Appends to the shared buffers, the bounding sphere is taken around the mesh origin
+        uint32_t addMesh(const SceneVertex *vertices, uint32_t vertexCount, const uint32_t *indices, uint32_t indexCount);
+
+        // Objects are added, moved and removed here
+        vks::GpuScene &getScene() { return scene; }
+
+        void setCamera(const mat4x4 &viewProjection) { camera = viewProjection; }
+
+        // Outside of the render pass or into an AsyncCompute command buffer, before draw()
+        void cull(VkCommandBuffer command, uint32_t frame);
+
+        // Inside the render pass, one indirect call for every object
+        void draw(VkCommandBuffer command, uint32_t frame);
+
+    private:
+        vks::VulkanDevice           *device;
+        vks::GpuScene               scene;
+        vks::Buffer                 vertices;
+        vks::Buffer                 indices;
+        uint32_t                    vertexCount;
+        uint32_t                    indexCount;
+        VkDescriptorSetLayout       setLayout = VK_NULL_HANDLE;
+        VkDescriptorPool            descriptorPool;
+        VkDescriptorSet             sets[vks::MAX_IMAGES_IN_FLIGHT];
+        VkPipeline                  scenePipeline;
+        VkPipelineLayout            pipelineLayout;
+        mat4x4                      camera;
+        bool                        ready = false;
+    };
+}
@@ -2,36 +2,384 @@
 // Created by arlev on 02.12.2022.
 //
 
-#include "Renderer.hpp"
+#include "RenderCommand.hpp"
+#include "GpuSceneRenderer.hpp"
+#include "Renderer2D.hpp"
 #include "Renderer3D.hpp"
+#include "VulkanInstance.hpp"
+#include "VulkanShaderLibrary.hpp"
+
+#include <GLFW/glfw3.h>
 
 namespace Mars
 {
     namespace Renderer
     {
-        void Init()
+        // Records the default render pass from what was submitted during the frame
+        class RenderBackend final : public vks::VulkanInstance
+        {
+        public:
+            void init(GLFWwindow *window, std::string_view gpuOverride)
+            {
+                int width = 0, height = 0;
+                glfwGetFramebufferSize(window, &width, &height);
+
+                // Up before initialise, which registers the render pass through renderPassChanged()
+                compileJobs.initialise(CompileThreads);
+                pipelines.initialise(&getDevice(), &compileJobs);
+
+                initialise(window, { uint32_t(width), uint32_t(height) }, 2, gpuOverride);
+
+                // Built from Mars/shaders by the MarsShaders target, pipelines find its shaders by id
+                if (shaders.initialise(getDevice(), ShaderArchive))
+                    shaders.registerAll(pipelines);
+
+                jobs.initialise();
+                renderer3D.initialise(&getDevice(), getFramesInFlight(), 16384, &jobs, &pipelines);
+                renderer2D.initialise(&getDevice(), getFramesInFlight(), &descriptorLayouts, &descriptorAllocator);
+                createSpriteLayout();
+            }
+
+            void destroy()
+            {
+                getDevice().graphicsTimeline.wait(getDevice().graphicsTimeline.lastSubmitted());
+                renderer2D.shutdown();
+                renderer3D.shutdown();
+                sceneRenderer.shutdown();
+                jobs.shutdown();
+                pipelines.shutdown();
+                vkDestroyPipelineLayout(getDevice(), spriteLayout, nullptr);
+                vkDestroyPipelineLayout(getDevice(), sceneLayout, nullptr);
+                shaders.shutdown();
+                compileJobs.shutdown();
+                shutdown();
+            }
+
+            // prepareFrame records through buildCommandBuffers, so the whole frame happens at the end
+            void render()
+            {
+                if (prepareFrame())
+                    submitFrame();
+            }
+
+            // Loads gpu_cull from the shader archive, later calls keep the scene that exists
+            bool initGpuScene(uint32_t maxObjects)
+            {
+                if (sceneRenderer.isReady())
+                    return true;
+
+                const auto cullShader = shaders.getModule("gpu_cull.comp.spv");
+
+                if (!sceneRenderer.initialise(&getDevice(), getFramesInFlight(), cullShader, maxObjects, &descriptorLayouts))
+                    return false;
+
+                sceneLayout = createPipelineLayout(sceneRenderer.getSetLayout());
+                pipelines.registerLayout(SceneLayout, sceneLayout);
+                buildScenePipeline();
+                return true;
+            }
+
+            void resize(uint32_t width, uint32_t height)
+            {
+                notifyResize({ width, height });
+            }
+
+            // Screen space in pixels, origin at the top left
+            mat4x4 screenProjection() const
+            {
+                const auto extent = getExtent();
+                return mat4x4::ortho(0.0f, float(extent.width), 0.0f, float(extent.height), -1.0f, 1.0f);
+            }
+
+            using VulkanInstance::getRenderPass;
+            using VulkanInstance::getSampleCount;
+
+            Renderer3D          renderer3D;
+            Renderer2D          renderer2D;
+            GpuSceneRenderer    sceneRenderer;
+            JobSystem           jobs;           // Sorts the draw queue
+            vks::PipelineCache  pipelines;
+            vks::ShaderLibrary  shaders;
+
+        protected:
+            // Compiles get their own workers, the sort waits for every job on its system to finish
+            static constexpr uint32_t CompileThreads = 2;
+            static constexpr const char *ShaderArchive = "shaders.pack";
+            static constexpr uint64_t SpriteLayout = 1;     // PipelineCache ids of the layouts below
+            static constexpr uint64_t SceneLayout = 2;
+
+            void renderPassChanged() override
+            {
+                // Compiles still holding the previous pass have to finish before the deletion queue frees it
+                pipelines.wait();
+                pipelines.registerRenderPass(DEFAULT_RENDER_PASS, getRenderPass());
+
+                // Formats are part of every PipelineDesc, cached pipelines of the previous pass are not reused
+                renderer3D.setTarget(getSurfaceFormat(), getDepthFormat(), getSampleCount());
+
+                // The target may have changed between the swapchain image and the upscaling target, the
+                // overlay is declared again before its next frame and the sprite pipeline built with it
+                overlayDirty = true;
+
+                // The pass may have new formats or a new sample count
+                if (sceneLayout != VK_NULL_HANDLE)
+                    buildScenePipeline();
+            }
+
+            void buildCommandBuffers() override
+            {
+                const auto command = commandBuffers[getCurrentFrame()];
+                const auto extent = getExtent();
+
+                const auto beginInfo = vks::Inits::commandBufferBeginInfo(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+                vkBeginCommandBuffer(command, &beginInfo);
+                gpuProfiler.beginFrame(command);
+                passQueries.beginFrame(command);
+
+                VkClearValue clearValues[2];
+                clearValues[0].color = { { 0.0f, 0.0f, 0.0f, 1.0f } };
+                clearValues[1].depthStencil = { 1.0f, 0 };
+
+                auto passInfo = vks::Inits::renderPassBeginInfo(getRenderPass(), extent);
+                passInfo.framebuffer = getFramebuffer();
+                passInfo.clearValueCount = arraysize32(clearValues);
+                passInfo.pClearValues = clearValues;
+
+                // Writes the indirect draws on the compute queue while the previous frame still rasterises,
+                // the frame's submission waits on it. Timed by the frame total, not by a region of this buffer.
+                if (sceneRenderer.isReady())
+                {
+                    const auto compute = asyncCompute.begin(getCurrentFrame());
+                    sceneRenderer.cull(compute, getCurrentFrame());
+                    asyncCompute.submit(VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT);
+                }
+
+                vkCmdBeginRenderPass(command, &passInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+                const auto viewport = vks::Inits::viewportInfo(extent);
+                const auto scissor = vks::Inits::scissorInfo(extent);
+                vkCmdSetViewport(command, 0, 1, &viewport);
+                vkCmdSetScissor(command, 0, 1, &scissor);
+
+                // The pass has a single subpass, so each query begins and ends inside it
+                {
+                    vks::GpuScope scope(gpuProfiler, command, "3D");
+                    const auto pass = passQueries.beginPass(command, "3D");
+                    renderer3D.flush(command, getCurrentFrame());
+                    passQueries.endPass(command, pass);
+                }
+
+                {
+                    vks::GpuScope scope(gpuProfiler, command, "GPU scene");
+                    const auto pass = passQueries.beginPass(command, "GPU scene");
+                    sceneRenderer.draw(command, getCurrentFrame());
+                    passQueries.endPass(command, pass);
+                }
+
+                vkCmdEndRenderPass(command);
+
+                if (renderer2D.getStats().quads > 0)
+                    drawOverlay(command);
+
+                vkEndCommandBuffer(command);
+            }
+
+        private:
+            // Both built-in pipelines take one set and the view projection as a vertex push constant
+            VkPipelineLayout createPipelineLayout(VkDescriptorSetLayout setLayout)
+            {
+                const auto pushRange = vks::Inits::pushConstantRange(VK_SHADER_STAGE_VERTEX_BIT, sizeof(mat4x4));
+
+                VkPipelineLayoutCreateInfo layoutInfo{};
+                layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+                layoutInfo.setLayoutCount = 1;
+                layoutInfo.pSetLayouts = &setLayout;
+                layoutInfo.pushConstantRangeCount = 1;
+                layoutInfo.pPushConstantRanges = &pushRange;
+
+                VkPipelineLayout layout = VK_NULL_HANDLE;
+                vkCreatePipelineLayout(getDevice(), &layoutInfo, nullptr, &layout);
+                return layout;
+            }
+
+            void createSpriteLayout()
+            {
+                spriteLayout = createPipelineLayout(renderer2D.getSetLayout());
+                pipelines.registerLayout(SpriteLayout, spriteLayout);
+            }
+
+            // Sprites are drawn over the default pass's resolved target in a single sampled pass of their
+            // own. The target is imported in the layout the default pass leaves it in and handed back in it.
+            void declareOverlay()
+            {
+                renderGraph.reset();
+                overlayTarget = renderGraph.importImage("Target", getSurfaceFormat(), { 0, 0 }, getTargetLayout(), getTargetLayout());
+
+                overlayPass = renderGraph.addGraphicsPass("2D", [this](vks::RGPassBuilder &builder){
+                    builder.colour(overlayTarget, VK_ATTACHMENT_LOAD_OP_LOAD);
+                }, [this](const vks::RGPassContext &context){
+                    vks::GpuScope scope(gpuProfiler, context.command, "2D");
+                    const auto pass = passQueries.beginPass(context.command, "2D");
+                    renderer2D.flush(context.command);
+                    passQueries.endPass(context.command, pass);
+                });
+
+                overlayDirty = false;
+            }
+
+            void drawOverlay(VkCommandBuffer command)
+            {
+                if (overlayDirty)
+                    declareOverlay();
+
+                // Follows the render extent, dynamic resolution recompiles the graph when it changes
+                renderGraph.setExtent(getExtent());
+
+                // A recompile replaces the pass, the cache finds the sprite pipeline again by formats
+                if (renderGraph.isDirty())
+                {
+                    renderGraph.compile();
+                    pipelines.registerRenderPass(OVERLAY_RENDER_PASS, renderGraph.getRenderPass(overlayPass));
+                    buildSpritePipeline();
+                }
+
+                renderGraph.bindImage(overlayTarget, getTargetImage(), getTargetView());
+                renderGraph.execute(command);
+            }
+
+            // Blocks on the compile, it only happens for the first overlay and when its formats change
+            void buildSpritePipeline()
+            {
+                vks::PipelineDesc desc;
+                desc.addStage(VK_SHADER_STAGE_VERTEX_BIT, vks::ShaderLibrary::shaderId("sprite.vert.spv"));
+                desc.addStage(VK_SHADER_STAGE_FRAGMENT_BIT, vks::ShaderLibrary::shaderId("sprite.frag.spv"));
+                desc.renderPass = OVERLAY_RENDER_PASS;
+                desc.layout = SpriteLayout;
+                desc.vertexStride = sizeof(SpriteVertex);
+
+                for (const auto &attribute : Renderer2D::VertexAttributes)
+                    desc.addAttribute(attribute.location, attribute.format, attribute.offset);
+
+                // Drawn over the 3D scene in submission order, the overlay has neither depth nor multisampling
+                desc.cullMode = VK_CULL_MODE_NONE;
+                desc.setTarget(getSurfaceFormat(), VK_FORMAT_UNDEFINED, VK_SAMPLE_COUNT_1_BIT);
+                desc.depthTest = VK_FALSE;
+                desc.depthWrite = VK_FALSE;
+                desc.blend[0].blendEnable = VK_TRUE;
+
+                const auto pipeline = pipelines.compile(desc);
+
+                if (pipeline == VK_NULL_HANDLE)
+                    std::cout << "Warning, sprite pipeline unavailable, 2D draws are skipped" << std::endl;
+
+                renderer2D.setPipeline(pipeline, spriteLayout);
+            }
+
+            void buildScenePipeline()
+            {
+                vks::PipelineDesc desc;
+                desc.addStage(VK_SHADER_STAGE_VERTEX_BIT, vks::ShaderLibrary::shaderId("scene.vert.spv"));
+                desc.addStage(VK_SHADER_STAGE_FRAGMENT_BIT, vks::ShaderLibrary::shaderId("scene.frag.spv"));
+                desc.renderPass = DEFAULT_RENDER_PASS;
+                desc.layout = SceneLayout;
+                desc.vertexStride = sizeof(SceneVertex);
+
+                for (const auto &attribute : GpuSceneRenderer::VertexAttributes)
+                    desc.addAttribute(attribute.location, attribute.format, attribute.offset);
+
+                // Winding depends on the application's projection, both faces are drawn
+                desc.cullMode = VK_CULL_MODE_NONE;
+                desc.setTarget(getSurfaceFormat(), getDepthFormat(), getSampleCount());
+
+                const auto pipeline = pipelines.compile(desc);
+
+                if (pipeline == VK_NULL_HANDLE)
+                    std::cout << "Warning, GPU scene pipeline unavailable, its objects are culled but not drawn" << std::endl;
+
+                sceneRenderer.setPipeline(pipeline, sceneLayout);
+            }
+
+            JobSystem           compileJobs;
+            VkPipelineLayout    spriteLayout = VK_NULL_HANDLE;
+            VkPipelineLayout    sceneLayout = VK_NULL_HANDLE;
+            vks::RGResource     overlayTarget = vks::RG_INVALID_RESOURCE;
+            uint32_t            overlayPass = 0;
+            bool                overlayDirty = true;    // Declared on the first frame with sprites
+        };
+
+        static RenderBackend *backend = nullptr;
+
+        void Init(GLFWwindow *window, std::string_view gpuOverride)
         {
-            //
+            backend = new RenderBackend();
+            backend->init(window, gpuOverride);
         }
 
         void Shutdown()
         {
-            //
+            if (backend == nullptr)
+                return;
+
+            backend->destroy();
+            delete backend;
+            backend = nullptr;
         }
 
         void OnEvent(Event &event)
         {
-            //
+            if (event.type == EventType::WindowSize && event.windowSize.width > 0 && event.windowSize.height > 0)
+                backend->resize(uint32_t(event.windowSize.width), uint32_t(event.windowSize.height));
         }
 
-        void BeginRender()
+        void BeginRender(vec3<float> cameraPosition)
         {
-            //
+            backend->renderer3D.beginFrame(cameraPosition);
+            backend->renderer2D.beginFrame(backend->screenProjection());
         }
 
         void EndRender()
         {
-            //
+            backend->render();
+        }
+
+        Renderer3D &Get3D()
+        {
+            return backend->renderer3D;
+        }
+
+        Renderer2D &Get2D()
+        {
+            return backend->renderer2D;
+        }
+
+        bool InitGpuScene(uint32_t maxObjects)
+        {
+            return backend->initGpuScene(maxObjects);
+        }
+
+        GpuSceneRenderer &GetGpuScene()
+        {
+            return backend->sceneRenderer;
+        }
+
+        VkRenderPass GetRenderPass()
+        {
+            return backend->getRenderPass();
+        }
+
+        VkSampleCountFlagBits GetSampleCount()
+        {
+            return backend->getSampleCount();
+        }
+
+        vks::PipelineCache &GetPipelines()
+        {
+            return backend->pipelines;
+        }
+
+        vks::ShaderLibrary &GetShaders()
+        {
+            return backend->shaders;
         }
     };
-}
\ No newline at end of file
+}
@@ -6,15 +6,53 @@
 
 #include "../Core/Base.hpp"
 #include "../Core/Events.hpp"
+#include "GpuSceneRenderer.hpp"
+#include "Renderer2D.hpp"
+#include "Renderer3D.hpp"
+#include "VulkanShaderLibrary.hpp"
+
+struct GLFWwindow;
 
 namespace Mars
 {
     namespace Renderer
     {
-        void Init();
+        // PipelineDesc::renderPass of the pass Renderer3D and the GPU scene draw in
+        constexpr uint64_t DEFAULT_RENDER_PASS = 0;
+
+        // The render graph pass Renderer2D draws in after it, single sampled without depth
+        constexpr uint64_t OVERLAY_RENDER_PASS = 1;
+
+        void Init(GLFWwindow *window, std::string_view gpuOverride = {});
         void Shutdown();
         void OnEvent(Event &event);
-        void BeginRender();
+
+        // Submissions made between these are sorted, batched and drawn by EndRender
+        void BeginRender(vec3<float> cameraPosition = vec3<float>(0.0f));
         void EndRender();
+
+        // Meshes, materials and pipelines are registered here, draws submitted after BeginRender
+        Renderer3D &Get3D();
+
+        // Sprites are drawn over the 3D scene in pixel coordinates with the sprite pipeline from Mars/shaders,
+        // in a render graph pass of their own that is skipped on frames without any
+        Renderer2D &Get2D();
+
+        // GPU driven objects, frustum culled by shaders/gpu_cull.comp and drawn with one indirect call after
+        // the 3D queue. Creates the scene with room for maxObjects, false when the device or shader archive
+        // cannot support it. Meshes and objects are added through GetGpuScene() afterwards.
+        bool InitGpuScene(uint32_t maxObjects);
+        GpuSceneRenderer &GetGpuScene();
+
+        // The pass Renderer3D draws in, what pipelines for Get3D().addPipeline are created against.
+        // Both are replaced when the surface format or sample tier change, pipelines with them.
+        VkRenderPass GetRenderPass();
+        VkSampleCountFlagBits GetSampleCount();
+
+        // Builds pipelines in the background, Get3D().addPipeline(desc, layout) requests through it
+        vks::PipelineCache &GetPipelines();
+
+        // Every shader of Mars/shaders, already registered with GetPipelines()
+        vks::ShaderLibrary &GetShaders();
     };
 }
\ No newline at end of file
@@ -0,0 +1,343 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#include "Renderer2D.hpp"
+
+#include <cmath>
+
+namespace Mars
+{
+    void Renderer2D::initialise(vks::VulkanDevice *dev,
+                                uint32_t frameCount,
+                                vks::DescriptorLayoutCache *layoutCache,
+                                vks::DescriptorAllocator *allocator)
+    {
+        device = dev;
+        descriptorAllocator = allocator;
+        framesInFlight = frameCount;
+        spritePipeline = VK_NULL_HANDLE;
+        pipelineLayout = VK_NULL_HANDLE;
+        current = framesInFlight - 1;
+        vertices = nullptr;
+        chunkQuads = 0;
+        textureCount = 0;
+        lastTexture = VK_NULL_HANDLE;
+        lastSlot = 0;
+        stats = {};
+
+        auto binding = vks::Inits::descriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                                                              VK_SHADER_STAGE_FRAGMENT_BIT);
+        binding.descriptorCount = MaxTextureSlots;
+
+        const VkDescriptorSetLayoutBinding bindings[] = { binding };
+        setLayout = layoutCache->getLayout(bindings);
+
+        const auto samplerInfo = vks::Inits::samplerCreateInfo();
+        vkCreateSampler(*device, &samplerInfo, nullptr, &textureSampler);
+
+        createWhiteTexture();
+
+        // Every quad has the same six indices relative to its first vertex, one buffer serves all batches
+        indices.create(device, MaxQuadsPerBatch * 6 * sizeof(uint32_t), VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        auto mapped = indices.data<uint32_t>();
+
+        for (uint32_t quad = 0; quad < MaxQuadsPerBatch; quad++)
+        {
+            const auto first = quad * 4;
+            mapped[0] = first;
+            mapped[1] = first + 1;
+            mapped[2] = first + 2;
+            mapped[3] = first + 2;
+            mapped[4] = first + 3;
+            mapped[5] = first;
+            mapped += 6;
+        }
+
+        indices.flush();
+
+        for (uint32_t i = 0; i < framesInFlight; i++)
+            frames[i].value = 0;
+    }
+
+    void Renderer2D::shutdown()
+    {
+        for (uint32_t i = 0; i < framesInFlight; i++)
+        {
+            auto &frame = frames[i];
+
+            for (auto &chunk : frame.chunks)
+                chunk.destroy();
+
+            frame.chunks.clear();
+            frame.batches.clear();
+        }
+
+        indices.destroy();
+        device->deletionQueue.push(white);
+        device->deletionQueue.push(whiteImage);
+        device->deletionQueue.push(whiteMemory);
+        device->deletionQueue.push(textureSampler);
+    }
+
+    void Renderer2D::setPipeline(VkPipeline pipeline, VkPipelineLayout layout)
+    {
+        spritePipeline = pipeline;
+        pipelineLayout = layout;
+    }
+
+    void Renderer2D::beginFrame(const mat4x4 &viewProjection)
+    {
+        auto &timeline = device->graphicsTimeline;
+
+        // The slot's frame has been submitted by now, nothing later touches its buffers
+        frames[current].value = timeline.lastSubmitted();
+        current = (current + 1) % framesInFlight;
+
+        auto &frame = frames[current];
+        timeline.wait(frame.value);
+        frame.batches.clear();
+
+        projection = viewProjection;
+        stats.quads = 0;
+        stats.textureBreaks = 0;
+        beginTime = std::chrono::steady_clock::now();
+
+        openBatch(0, 0);
+    }
+
+    void Renderer2D::drawQuad(vec2<float> position, vec2<float> size, uint32_t colour)
+    {
+        uint32_t slot;
+        auto quad = reserveQuad(white, slot);
+
+        const auto hx = size.x * 0.5f;
+        const auto hy = size.y * 0.5f;
+
+        quad[0] = { position.x - hx, position.y - hy, 0.0f, 0.0f, colour, slot };
+        quad[1] = { position.x + hx, position.y - hy, 1.0f, 0.0f, colour, slot };
+        quad[2] = { position.x + hx, position.y + hy, 1.0f, 1.0f, colour, slot };
+        quad[3] = { position.x - hx, position.y + hy, 0.0f, 1.0f, colour, slot };
+    }
+
+    void Renderer2D::drawSprite(vec2<float> position,
+                                vec2<float> size,
+                                float rotation,
+                                VkImageView texture,
+                                vec4<float> uvRect,
+                                uint32_t tint)
+    {
+        uint32_t slot;
+        auto quad = reserveQuad(texture, slot);
+
+        const auto cosine = rotation != 0.0f ? std::cos(rotation) : 1.0f;
+        const auto sine = rotation != 0.0f ? std::sin(rotation) : 0.0f;
+
+        // Half extents along the rotated axes
+        const auto ax = vec2<float>(cosine, sine) * (size.x * 0.5f);
+        const auto ay = vec2<float>(-sine, cosine) * (size.y * 0.5f);
+
+        const auto p0 = position - ax - ay;
+        const auto p1 = position + ax - ay;
+        const auto p2 = position + ax + ay;
+        const auto p3 = position - ax + ay;
+
+        // uvRect is (u0, v0, u1, v1) inside the atlas
+        quad[0] = { p0.x, p0.y, uvRect.x, uvRect.y, tint, slot };
+        quad[1] = { p1.x, p1.y, uvRect.z, uvRect.y, tint, slot };
+        quad[2] = { p2.x, p2.y, uvRect.z, uvRect.w, tint, slot };
+        quad[3] = { p3.x, p3.y, uvRect.x, uvRect.w, tint, slot };
+    }
+
+    void Renderer2D::flush(VkCommandBuffer command)
+    {
+        auto &frame = frames[current];
+
+        stats.drawCalls = 0;
+
+        if (frame.batches.empty())
+            return;
+
+        closeBatch();
+        stats.submitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - beginTime).count();
+
+        if (spritePipeline == VK_NULL_HANDLE || stats.quads == 0)
+        {
+            frame.batches.clear();
+            return;
+        }
+
+        vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_GRAPHICS, spritePipeline);
+        vks::Tools::PushConstants(command, pipelineLayout,
+                                  vks::Inits::pushConstantRange(VK_SHADER_STAGE_VERTEX_BIT, sizeof(mat4x4)), &projection);
+        vkCmdBindIndexBuffer(command, indices, 0, VK_INDEX_TYPE_UINT32);
+
+        uint32_t boundChunk = UINT32_MAX;
+
+        for (const auto &batch : frame.batches)
+        {
+            if (batch.quadCount == 0)
+                continue;
+
+            if (batch.chunk != boundChunk)
+            {
+                const VkBuffer buffer = frame.chunks[batch.chunk];
+                const VkDeviceSize offset = 0;
+                vkCmdBindVertexBuffers(command, 0, 1, &buffer, &offset);
+                boundChunk = batch.chunk;
+            }
+
+            vkCmdBindDescriptorSets(command, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &batch.set, 0, nullptr);
+            vkCmdDrawIndexed(command, batch.quadCount * 6, 1, 0, int32_t(batch.firstQuad * 4), 0);
+            stats.drawCalls++;
+        }
+
+        frame.batches.clear();
+    }
+
+    uint32_t Renderer2D::packColour(vec4<float> colour)
+    {
+        const auto channel = [](float value){ return uint32_t(clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f); };
+        return channel(colour.x) | channel(colour.y) << 8 | channel(colour.z) << 16 | channel(colour.w) << 24;
+    }
+
+    SpriteVertex *Renderer2D::reserveQuad(VkImageView texture, uint32_t &slot)
+    {
+        if (chunkQuads == MaxQuadsPerBatch)
+        {
+            const auto next = frames[current].batches.back().chunk + 1;
+            closeBatch();
+            openBatch(next, 0);
+        }
+
+        slot = textureSlot(texture);
+
+        if (slot == MaxTextureSlots)
+        {
+            const auto chunk = frames[current].batches.back().chunk;
+            closeBatch();
+            openBatch(chunk, chunkQuads);
+            stats.textureBreaks++;
+            slot = textureSlot(texture);
+        }
+
+        frames[current].batches.back().quadCount++;
+        stats.quads++;
+        return vertices + 4 * chunkQuads++;
+    }
+
+    uint32_t Renderer2D::textureSlot(VkImageView texture)
+    {
+        // Consecutive sprites mostly come from the same atlas
+        if (texture == lastTexture)
+            return lastSlot;
+
+        uint32_t slot = 0;
+        while (slot < textureCount && textures[slot] != texture)
+            slot++;
+
+        if (slot == MaxTextureSlots)
+            return MaxTextureSlots;
+
+        if (slot == textureCount)
+            textures[textureCount++] = texture;
+
+        lastTexture = texture;
+        lastSlot = slot;
+        return slot;
+    }
+
+    void Renderer2D::closeBatch()
+    {
+        auto &frame = frames[current];
+        auto &batch = frame.batches.back();
+
+        if (batch.quadCount == 0)
+            return;
+
+        // Per-frame set, the allocator recycles its pool once the frame's submission completes
+        batch.set = descriptorAllocator->allocate(setLayout);
+
+        VkDescriptorImageInfo imageInfos[MaxTextureSlots];
+
+        for (uint32_t i = 0; i < MaxTextureSlots; i++)
+        {
+            imageInfos[i].sampler = textureSampler;
+            imageInfos[i].imageView = i < textureCount ? textures[i] : white;
+            imageInfos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        }
+
+        auto write = vks::Inits::writeDescriptorSet(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, batch.set, imageInfos);
+        write.descriptorCount = MaxTextureSlots;
+        vkUpdateDescriptorSets(*device, 1, &write, 0, nullptr);
+
+        constexpr VkDeviceSize QuadSize = 4 * sizeof(SpriteVertex);
+        frame.chunks[batch.chunk].flush(batch.firstQuad * QuadSize, batch.quadCount * QuadSize);
+    }
+
+    void Renderer2D::openBatch(uint32_t chunk, uint32_t firstQuad)
+    {
+        auto &frame = frames[current];
+
+        // Chunks stay with their slot, a frame only allocates what the largest frame so far did not
+        if (chunk == frame.chunks.size())
+        {
+            vks::Buffer buffer;
+            buffer.create(device, MaxQuadsPerBatch * 4 * sizeof(SpriteVertex), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+            frame.chunks.push_back(buffer);
+            stats.chunks++;
+        }
+
+        vertices = frame.chunks[chunk].data<SpriteVertex>();
+        chunkQuads = firstQuad;
+        textureCount = 0;
+        lastTexture = VK_NULL_HANDLE;
+
+        frame.batches.push_back({ chunk, firstQuad, 0, VK_NULL_HANDLE });
+    }
+
+    void Renderer2D::createWhiteTexture()
+    {
+        auto imageInfo = vks::Inits::imageCreateInfo();
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.extent = { 1, 1, 1 };
+        imageInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+        imageInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        vkCreateImage(*device, &imageInfo, nullptr, &whiteImage);
+
+        VkMemoryRequirements memReqs{};
+        vkGetImageMemoryRequirements(*device, whiteImage, &memReqs);
+
+        auto allocInfo = device->getMemoryAllocInfo(memReqs, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        device->allocateMemory(allocInfo, &whiteMemory);
+        vkBindImageMemory(*device, whiteImage, whiteMemory, 0);
+
+        auto viewInfo = vks::Inits::imageViewCreateInfo();
+        viewInfo.image = whiteImage;
+        viewInfo.format = imageInfo.format;
+        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        vkCreateImageView(*device, &viewInfo, nullptr, &white);
+
+        vks::Buffer staging;
+        staging.create(device, sizeof(uint32_t), VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        *staging.data<uint32_t>() = 0xFFFFFFFF;
+
+        const auto command = device->createCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+
+        vks::Tools::SetImageLayout(command, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                   VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, whiteImage);
+
+        const auto region = vks::Inits::bufferImageCopy({ 1, 1 });
+        vkCmdCopyBufferToImage(command, staging, whiteImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+        vks::Tools::SetImageLayout(command, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                   VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, whiteImage);
+
+        device->flushCommandBuffer(command);
+        staging.destroy();
+    }
+}
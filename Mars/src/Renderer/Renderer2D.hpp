@@ -0,0 +1,133 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#pragma once
+
+#include "VulkanBuffer.hpp"
+#include "VulkanDescriptors.hpp"
+
+#include <chrono>
+#include <cstddef>
+
+namespace Mars
+{
+    struct SpriteVertex
+    {
+        float       x, y;
+        float       u, v;
+        uint32_t    colour;         // RGBA8, R in the lowest byte
+        uint32_t    texture;        // Slot in the batch's texture array
+    };
+
+    // Writes quads straight into persistently mapped per-frame vertex buffers, one 64k quad chunk at a
+    // time, and draws every chunk with as few vkCmdDrawIndexed as texture use allows. Each batch binds an
+    // array of up to MaxTextureSlots textures and vertices pick theirs by slot, so switching between
+    // sprites of a handful of atlases never breaks a batch. A batch is closed when its chunk is full or a
+    // texture needs a slot that is not left, the next one carries on in the same or a new chunk.
+    //
+    // Textures have to be in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL.
+    // Pipelines are created against getSetLayout() at set 0, a vertex stage push constant holding the
+    // view projection matrix and VertexAttributes at binding 0, see shaders/sprite.vert and sprite.frag.
+    // The render backend builds one from those for its render pass and sets it again whenever the pass changes.
+    class Renderer2D
+    {
+        struct Batch
+        {
+            uint32_t            chunk;
+            uint32_t            firstQuad;      // Inside the chunk
+            uint32_t            quadCount;
+            VkDescriptorSet     set;
+        };
+
+        struct Frame
+        {
+            std::vector<vks::Buffer>        chunks;
+            std::vector<Batch>              batches;
+            uint64_t                        value;      // Graphics timeline value of the slot's last frame
+        };
+
+    public:
+        static constexpr uint32_t MaxQuadsPerBatch = 65536;
+        static constexpr uint32_t MaxTextureSlots = 16;      // maxPerStageDescriptorSamplers is at least 16
+
+        static constexpr VkVertexInputAttributeDescription VertexAttributes[] = {
+                { 0, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(SpriteVertex, x) },
+                { 1, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(SpriteVertex, u) },
+                { 2, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(SpriteVertex, colour) },
+                { 3, 0, VK_FORMAT_R32_UINT, offsetof(SpriteVertex, texture) }
+        };
+
+        struct Stats
+        {
+            uint32_t    quads;
+            uint32_t    drawCalls;
+            uint32_t    textureBreaks;      // Batches closed because the texture slots ran out
+            uint32_t    chunks;             // Vertex buffers allocated over all frame slots
+            double      submitMs;           // Between beginFrame() and flush()
+        };
+
+        // Sprites are sampled linearly with clamped edges, a 1x1 white texture backs untextured quads.
+        // Batch sets come from allocator, which has to be moved on with nextFrame() after every submission.
+        void initialise(vks::VulkanDevice *dev,
+                        uint32_t frameCount,
+                        vks::DescriptorLayoutCache *layoutCache,
+                        vks::DescriptorAllocator *allocator);
+        void shutdown();
+
+        void setPipeline(VkPipeline pipeline, VkPipelineLayout layout);
+        VkDescriptorSetLayout getSetLayout() const { return setLayout; }
+
+        // Moves on to the next frame slot and waits for the GPU to finish the frame that used it last
+        void beginFrame(const mat4x4 &viewProjection);
+
+        // position is the quad's centre, rotation in radians around it
+        void drawQuad(vec2<float> position, vec2<float> size, uint32_t colour);
+        void drawSprite(vec2<float> position,
+                        vec2<float> size,
+                        float rotation,
+                        VkImageView texture,
+                        vec4<float> uvRect = vec4<float>(0.0f, 0.0f, 1.0f, 1.0f),
+                        uint32_t tint = 0xFFFFFFFF);
+
+        // Records every batch of the frame inside the current render pass
+        void flush(VkCommandBuffer command);
+
+        static uint32_t packColour(vec4<float> colour);
+
+        const Stats &getStats() const { return stats; }
+
+    private:
+        SpriteVertex *reserveQuad(VkImageView texture, uint32_t &slot);
+        uint32_t textureSlot(VkImageView texture);
+        void closeBatch();
+        void openBatch(uint32_t chunk, uint32_t firstQuad);
+        void createWhiteTexture();
+
+        vks::VulkanDevice           *device;
+        vks::DescriptorAllocator    *descriptorAllocator;
+        VkDescriptorSetLayout       setLayout;
+        VkSampler                   textureSampler;
+        VkImage                     whiteImage;
+        VkDeviceMemory              whiteMemory;
+        VkImageView                 white;
+        VkPipeline                  spritePipeline;
+        VkPipelineLayout            pipelineLayout;
+        vks::Buffer                 indices;
+        Frame                       frames[vks::MAX_IMAGES_IN_FLIGHT];
+        uint32_t                    framesInFlight;
+        uint32_t                    current;
+        mat4x4                      projection;
+
+        // The open batch
+        SpriteVertex                *vertices;      // Mapped chunk memory
+        uint32_t                    chunkQuads;     // Quads written to the open chunk
+        VkImageView                 textures[MaxTextureSlots];
+        uint32_t                    textureCount;
+        VkImageView                 lastTexture;
+        uint32_t                    lastSlot;
+
+        std::chrono::steady_clock::time_point   beginTime;
+        Stats                       stats;
+    };
+}
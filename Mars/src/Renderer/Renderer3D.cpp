@@ -0,0 +1,294 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#include "Renderer3D.hpp"
+
+#include <bit>
+#include <chrono>
+
+namespace Mars
+{
+    void Renderer3D::initialise(vks::VulkanDevice *dev,
+                                uint32_t frameCount,
+                                uint32_t initialInstances,
+                                JobSystem *jobSystem,
+                                vks::PipelineCache *cache)
+    {
+        device = dev;
+        pipelineCache = cache;
+        framesInFlight = frameCount;
+        backToFrontPasses = 0;
+        camera = vec3<float>(0.0f);
+        stats = {};
+        sorter.initialise(jobSystem);
+
+        for (uint32_t i = 0; i < framesInFlight; i++)
+        {
+            capacities[i] = 0;
+            ensureCapacity(i, initialInstances);
+        }
+    }
+
+    void Renderer3D::shutdown()
+    {
+        for (uint32_t i = 0; i < framesInFlight; i++)
+            instances[i].destroy();
+
+        pipelines.clear();
+        descs.clear();
+        materials.clear();
+        meshes.clear();
+        queue.clear();
+        transforms.clear();
+    }
+
+    uint32_t Renderer3D::addPipeline(VkPipeline pipeline, VkPipelineLayout layout)
+    {
+        if (pipelines.size() >= (1u << DrawKey::PipelineBits))
+            return INVALID_RENDER_HANDLE;
+
+        pipelines.push_back({ pipeline, layout, INVALID_RENDER_HANDLE });
+        return uint32_t(pipelines.size() - 1);
+    }
+
+    uint32_t Renderer3D::addPipeline(const vks::PipelineDesc &desc, VkPipelineLayout layout)
+    {
+        if (pipelineCache == nullptr || pipelines.size() >= (1u << DrawKey::PipelineBits))
+            return INVALID_RENDER_HANDLE;
+
+        descs.push_back(desc);
+        descs.back().setTarget(colourFormat, depthFormat, sampleCount);
+        pipelines.push_back({ pipelineCache->request(descs.back()), layout, uint32_t(descs.size() - 1) });
+        return uint32_t(pipelines.size() - 1);
+    }
+
+    void Renderer3D::setTarget(VkFormat colour, VkFormat depth, VkSampleCountFlagBits samples)
+    {
+        colourFormat = colour;
+        depthFormat = depth;
+        sampleCount = samples;
+
+        for (auto &desc : descs)
+            desc.setTarget(colour, depth, samples);
+
+        // resolvePipelines asks the cache again, the old handles belong to the previous formats
+        for (auto &pipeline : pipelines)
+        {
+            if (pipeline.desc != INVALID_RENDER_HANDLE)
+                pipeline.pipeline = VK_NULL_HANDLE;
+        }
+    }
+
+    uint32_t Renderer3D::addMaterial(uint32_t pipeline, VkDescriptorSet set)
+    {
+        // The pipeline is packed into every draw key of the material and indexes pipelines in flush
+        if (pipeline >= pipelines.size() || materials.size() >= (1u << DrawKey::MaterialBits))
+            return INVALID_RENDER_HANDLE;
+
+        materials.push_back({ pipeline, set });
+        return uint32_t(materials.size() - 1);
+    }
+
+    uint32_t Renderer3D::addMesh(VkBuffer vertexBuffer,
+                                 VkBuffer indexBuffer,
+                                 uint32_t indexCount,
+                                 uint32_t firstIndex,
+                                 int32_t vertexOffset,
+                                 VkIndexType indexType)
+    {
+        if (meshes.size() >= (1u << DrawKey::MeshBits))
+            return INVALID_RENDER_HANDLE;
+
+        meshes.push_back({ vertexBuffer, indexBuffer, indexType, indexCount, firstIndex, vertexOffset });
+        return uint32_t(meshes.size() - 1);
+    }
+
+    void Renderer3D::setPassBackToFront(uint32_t pass, bool backToFront)
+    {
+        if (backToFront)
+            backToFrontPasses |= 1u << pass;
+        else
+            backToFrontPasses &= ~(1u << pass);
+    }
+
+    void Renderer3D::beginFrame(vec3<float> cameraPosition)
+    {
+        camera = cameraPosition;
+        stats.rejected = 0;
+        queue.clear();
+        transforms.clear();
+    }
+
+    void Renderer3D::submit(uint32_t mesh, uint32_t material, const mat4x4 &transform, uint32_t pass)
+    {
+        // Out of range fields would bleed into their neighbours in the draw key
+        if (mesh >= meshes.size() || material >= materials.size() || pass >= MaxPasses ||
+            materials[material].pipeline >= pipelines.size())
+        {
+            stats.rejected++;
+            return;
+        }
+
+        auto matrix = transform;
+        const auto offset = vec3<float>(matrix(3, 0), matrix(3, 1), matrix(3, 2)) - camera;
+
+        auto depth = depthBits(dot(offset, offset));
+
+        if (backToFrontPasses & (1u << pass))
+            depth = ~depth & 0xFFFF;
+
+        const auto key = DrawKey::pack(pass, materials[material].pipeline, material, mesh, depth);
+        queue.push_back({ key, uint32_t(transforms.size()) });
+        transforms.push_back(transform);
+    }
+
+    void Renderer3D::flush(VkCommandBuffer command, uint32_t frame)
+    {
+        const auto count = uint32_t(queue.size());
+
+        stats.submissions = count;
+        stats.drawCalls = 0;
+        stats.skippedDraws = 0;
+        stats.stateChanges = 0;
+        countUnbatched();
+
+        if (count == 0)
+            return;
+
+        resolvePipelines();
+
+        const auto sortStart = std::chrono::steady_clock::now();
+        sorter.sort(queue);
+        stats.sortMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - sortStart).count();
+
+        ensureCapacity(frame, count);
+
+        auto &instanceBuffer = instances[frame];
+        auto mapped = instanceBuffer.data<mat4x4>();
+
+        for (uint32_t i = 0; i < count; i++)
+            mapped[i] = transforms[queue[i].index];
+
+        instanceBuffer.flush(0, count * sizeof(mat4x4));
+
+        const VkBuffer instanceBuffers[] = { instanceBuffer };
+        const VkDeviceSize instanceOffsets[] = { 0 };
+        vkCmdBindVertexBuffers(command, InstanceBinding, 1, instanceBuffers, instanceOffsets);
+
+        uint32_t boundPipeline = INVALID_RENDER_HANDLE;
+        uint32_t boundMaterial = INVALID_RENDER_HANDLE;
+        uint32_t boundMesh = INVALID_RENDER_HANDLE;
+
+        for (uint32_t first = 0; first < count;)
+        {
+            const auto key = queue[first].key;
+            const auto pipeline = DrawKey::pipeline(key);
+            const auto material = DrawKey::material(key);
+            const auto mesh = DrawKey::mesh(key);
+
+            // Depth is the only field allowed to differ inside a run
+            constexpr uint64_t BatchMask = ~((uint64_t(1) << DrawKey::DepthBits) - 1);
+
+            uint32_t last = first + 1;
+            while (last < count && (queue[last].key & BatchMask) == (key & BatchMask))
+                last++;
+
+            if (pipelines[pipeline].pipeline == VK_NULL_HANDLE)
+            {
+                stats.skippedDraws++;
+                first = last;
+                continue;
+            }
+
+            if (pipeline != boundPipeline)
+            {
+                vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelines[pipeline].pipeline);
+                boundPipeline = pipeline;
+                boundMaterial = INVALID_RENDER_HANDLE;
+                stats.stateChanges++;
+            }
+
+            if (material != boundMaterial)
+            {
+                vkCmdBindDescriptorSets(command, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelines[pipeline].layout,
+                                        0, 1, &materials[material].set, 0, nullptr);
+                boundMaterial = material;
+                stats.stateChanges++;
+            }
+
+            const auto &drawMesh = meshes[mesh];
+
+            if (mesh != boundMesh)
+            {
+                const VkDeviceSize offset = 0;
+                vkCmdBindVertexBuffers(command, 0, 1, &drawMesh.vertexBuffer, &offset);
+                vkCmdBindIndexBuffer(command, drawMesh.indexBuffer, 0, drawMesh.indexType);
+                boundMesh = mesh;
+                stats.stateChanges++;
+            }
+
+            vkCmdDrawIndexed(command, drawMesh.indexCount, last - first, drawMesh.firstIndex, drawMesh.vertexOffset, first);
+            stats.drawCalls++;
+            first = last;
+        }
+    }
+
+    void Renderer3D::resolvePipelines()
+    {
+        // Ready pipelines keep their handle, only the ones still compiling ask again
+        for (auto &pipeline : pipelines)
+        {
+            if (pipeline.pipeline == VK_NULL_HANDLE && pipeline.desc != INVALID_RENDER_HANDLE)
+                pipeline.pipeline = pipelineCache->request(descs[pipeline.desc]);
+        }
+    }
+
+    uint32_t Renderer3D::depthBits(float distanceSquared)
+    {
+        // Positive floats order like their bit patterns, the top half keeps sign, exponent and 7 mantissa bits
+        return std::bit_cast<uint32_t>(distanceSquared) >> 16;
+    }
+
+    void Renderer3D::ensureCapacity(uint32_t frame, uint32_t instanceCount)
+    {
+        if (instanceCount <= capacities[frame])
+            return;
+
+        auto capacity = max(capacities[frame], 1024u);
+
+        while (capacity < instanceCount)
+            capacity *= 2;
+
+        // The old buffer may still be read by the slot's last frame, it goes through the deletion queue
+        instances[frame].destroy();
+        instances[frame].create(device, capacity * sizeof(mat4x4), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        capacities[frame] = capacity;
+    }
+
+    void Renderer3D::countUnbatched()
+    {
+        // Every submission drawn on its own in submission order, only redundant binds skipped
+        uint32_t pipeline = INVALID_RENDER_HANDLE;
+        uint32_t material = INVALID_RENDER_HANDLE;
+        uint32_t mesh = INVALID_RENDER_HANDLE;
+
+        stats.unbatchedDrawCalls = uint32_t(queue.size());
+        stats.unbatchedStateChanges = 0;
+
+        for (const auto &item : queue)
+        {
+            const auto itemPipeline = DrawKey::pipeline(item.key);
+            const auto itemMaterial = DrawKey::material(item.key);
+            const auto itemMesh = DrawKey::mesh(item.key);
+
+            stats.unbatchedStateChanges += (itemPipeline != pipeline) + (itemMaterial != material || itemPipeline != pipeline) +
+                                           (itemMesh != mesh);
+
+            pipeline = itemPipeline;
+            material = itemMaterial;
+            mesh = itemMesh;
+        }
+    }
+}
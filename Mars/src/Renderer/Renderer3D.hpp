@@ -0,0 +1,156 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#pragma once
+
+#include "VulkanBuffer.hpp"
+#include "VulkanPipelineCache.hpp"
+#include "../Core/RadixSort.hpp"
+
+namespace Mars
+{
+    constexpr uint32_t INVALID_RENDER_HANDLE = UINT32_MAX;
+
+    // Draws are sorted by one 64-bit key, most significant field first:
+    //  pass (4) | pipeline (12) | material (16) | mesh (16) | depth (16)
+    // so identical mesh and material runs end up next to each other and become one instanced draw.
+    struct DrawKey
+    {
+        static constexpr uint32_t PassBits = 4;
+        static constexpr uint32_t PipelineBits = 12;
+        static constexpr uint32_t MaterialBits = 16;
+        static constexpr uint32_t MeshBits = 16;
+        static constexpr uint32_t DepthBits = 16;
+
+        static constexpr uint64_t pack(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t mesh, uint32_t depth)
+        {
+            return uint64_t(pass) << (PipelineBits + MaterialBits + MeshBits + DepthBits) |
+                   uint64_t(pipeline) << (MaterialBits + MeshBits + DepthBits) |
+                   uint64_t(material) << (MeshBits + DepthBits) |
+                   uint64_t(mesh) << DepthBits |
+                   uint64_t(depth);
+        }
+
+        static constexpr uint32_t pass(uint64_t key) { return uint32_t(key >> (PipelineBits + MaterialBits + MeshBits + DepthBits)); }
+        static constexpr uint32_t pipeline(uint64_t key) { return uint32_t(key >> (MaterialBits + MeshBits + DepthBits)) & ((1u << PipelineBits) - 1); }
+        static constexpr uint32_t material(uint64_t key) { return uint32_t(key >> (MeshBits + DepthBits)) & ((1u << MaterialBits) - 1); }
+        static constexpr uint32_t mesh(uint64_t key) { return uint32_t(key >> DepthBits) & ((1u << MeshBits) - 1); }
+    };
+
+    // Collects (mesh, material, transform) submissions for a frame, sorts them by DrawKey and records
+    // every run of the same mesh and material as a single instanced vkCmdDrawIndexed. Transforms are
+    // copied into a per-frame instance buffer in sorted order, so each run is a contiguous range.
+    // Pipelines read the instance transform from vertex binding 1 at per-instance rate, four vec4
+    // attributes of a column major mat4. Materials bind their descriptor set at set 0.
+    // Pipelines added by PipelineDesc are requested from the pipeline cache at flush, runs drawn with
+    // one that is still compiling are skipped for the frame.
+    class Renderer3D
+    {
+        struct Mesh
+        {
+            VkBuffer        vertexBuffer;
+            VkBuffer        indexBuffer;
+            VkIndexType     indexType;
+            uint32_t        indexCount;
+            uint32_t        firstIndex;
+            int32_t         vertexOffset;
+        };
+
+        struct Material
+        {
+            uint32_t        pipeline;
+            VkDescriptorSet set;
+        };
+
+        struct Pipeline
+        {
+            VkPipeline          pipeline;
+            VkPipelineLayout    layout;
+            uint32_t            desc;           // Into descs, INVALID_RENDER_HANDLE for a pipeline given as is
+        };
+
+    public:
+        static constexpr uint32_t InstanceBinding = 1;
+        static constexpr uint32_t MaxPasses = 1u << DrawKey::PassBits;
+
+        struct Stats
+        {
+            uint32_t    submissions;
+            uint32_t    rejected;               // Submissions with an invalid mesh, material or pass
+            uint32_t    drawCalls;
+            uint32_t    skippedDraws;           // Runs whose pipeline was not compiled yet
+            uint32_t    stateChanges;           // Pipeline, descriptor set and mesh buffer binds
+            uint32_t    unbatchedDrawCalls;     // What submission order without batching would have cost
+            uint32_t    unbatchedStateChanges;
+            double      sortMs;
+        };
+
+        // Large queues are sorted on the job system's workers when one is given
+        void initialise(vks::VulkanDevice *dev,
+                        uint32_t frameCount,
+                        uint32_t initialInstances = 16384,
+                        JobSystem *jobSystem = nullptr,
+                        vks::PipelineCache *cache = nullptr);
+        void shutdown();
+
+        uint32_t addPipeline(VkPipeline pipeline, VkPipelineLayout layout);
+
+        // Compiled in the background, the shaders and layout desc references have to be registered with
+        // the pipeline cache given to initialise. Formats and sample count are taken from setTarget.
+        uint32_t addPipeline(const vks::PipelineDesc &desc, VkPipelineLayout layout);
+        // INVALID_RENDER_HANDLE when pipeline was not returned by addPipeline
+        uint32_t addMaterial(uint32_t pipeline, VkDescriptorSet set);
+        uint32_t addMesh(VkBuffer vertexBuffer,
+                         VkBuffer indexBuffer,
+                         uint32_t indexCount,
+                         uint32_t firstIndex = 0,
+                         int32_t vertexOffset = 0,
+                         VkIndexType indexType = VK_INDEX_TYPE_UINT32);
+
+        // Attachments of the pass flush records into, may be called before initialise. Pipelines added by
+        // PipelineDesc are requested again for the new formats, ones given as is have to be replaced.
+        void setTarget(VkFormat colour, VkFormat depth, VkSampleCountFlagBits samples);
+
+        // Transparent passes sort far to near instead
+        void setPassBackToFront(uint32_t pass, bool backToFront);
+
+        // Clears the queue, depth keys are measured from cameraPosition
+        void beginFrame(vec3<float> cameraPosition);
+
+        // Handles that are INVALID_RENDER_HANDLE or out of range and passes from MaxPasses on are dropped
+        void submit(uint32_t mesh, uint32_t material, const mat4x4 &transform, uint32_t pass = 0);
+
+        // Sorts, uploads the instances and records the draws inside the current render pass.
+        // The frame slot's previous submission has to have completed.
+        void flush(VkCommandBuffer command, uint32_t frame);
+
+        const Stats &getStats() const { return stats; }
+
+    private:
+        static uint32_t depthBits(float distanceSquared);
+
+        void ensureCapacity(uint32_t frame, uint32_t instanceCount);
+        void countUnbatched();
+        void resolvePipelines();
+
+        vks::VulkanDevice           *device;
+        vks::PipelineCache          *pipelineCache;
+        vks::Buffer                 instances[vks::MAX_IMAGES_IN_FLIGHT];
+        uint32_t                    capacities[vks::MAX_IMAGES_IN_FLIGHT];
+        uint32_t                    framesInFlight;
+        std::vector<Pipeline>       pipelines;
+        std::vector<vks::PipelineDesc> descs;
+        VkFormat                    colourFormat = VK_FORMAT_UNDEFINED;
+        VkFormat                    depthFormat = VK_FORMAT_UNDEFINED;
+        VkSampleCountFlagBits       sampleCount = VK_SAMPLE_COUNT_1_BIT;
+        std::vector<Material>       materials;
+        std::vector<Mesh>           meshes;
+        std::vector<SortKey>        queue;          // Index into transforms
+        RadixSorter                 sorter;
+        std::vector<mat4x4>         transforms;
+        vec3<float>                 camera;
+        uint32_t                    backToFrontPasses;      // One bit per pass
+        Stats                       stats;
+    };
+}
@@ -0,0 +1,229 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#include "VulkanBarriers.hpp"
+
+namespace vks
+{
+    constexpr VkAccessFlags WriteAccessMask = VK_ACCESS_SHADER_WRITE_BIT |
+                                              VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                              VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+                                              VK_ACCESS_TRANSFER_WRITE_BIT |
+                                              VK_ACCESS_HOST_WRITE_BIT |
+                                              VK_ACCESS_MEMORY_WRITE_BIT;
+
+    void ImageTracker::track(VkImage image, VkImageAspectFlags aspect, uint32_t levels, uint32_t layers, const ImageState &initial)
+    {
+        auto &tracked = images[image];
+        tracked.aspect = aspect;
+        tracked.levels = levels;
+        tracked.layers = layers;
+        tracked.current.assign(levels * layers, initial);
+        tracked.target.assign(levels * layers, initial);
+        tracked.pending.assign(levels * layers, false);
+        tracked.queued = false;
+    }
+
+    void ImageTracker::untrack(VkImage image)
+    {
+        const auto it = images.find(image);
+
+        if (it == images.end())
+            return;
+
+        if (it->second.queued)
+            std::erase(queuedImages, image);
+
+        images.erase(it);
+    }
+
+    void ImageTracker::setState(VkImage image, const ImageState &state, const VkImageSubresourceRange &range)
+    {
+        auto &tracked = images.at(image);
+        const auto levelEnd = min(tracked.levels, range.baseMipLevel + min(range.levelCount, tracked.levels));
+        const auto layerEnd = min(tracked.layers, range.baseArrayLayer + min(range.layerCount, tracked.layers));
+
+        for (uint32_t level = range.baseMipLevel; level < levelEnd; level++)
+        {
+            for (uint32_t layer = range.baseArrayLayer; layer < layerEnd; layer++)
+            {
+                const auto i = level * tracked.layers + layer;
+                tracked.current[i] = state;
+                tracked.target[i] = state;
+                tracked.pending[i] = false;
+            }
+        }
+    }
+
+    ImageState ImageTracker::getState(VkImage image, uint32_t level, uint32_t layer) const
+    {
+        const auto &tracked = images.at(image);
+        return tracked.target[level * tracked.layers + layer];
+    }
+
+    void ImageTracker::require(VkImage image, const ImageState &target, const VkImageSubresourceRange &range)
+    {
+        auto &tracked = images.at(image);
+        const auto levelEnd = min(tracked.levels, range.baseMipLevel + min(range.levelCount, tracked.levels));
+        const auto layerEnd = min(tracked.layers, range.baseArrayLayer + min(range.layerCount, tracked.layers));
+
+        for (uint32_t level = range.baseMipLevel; level < levelEnd; level++)
+        {
+            for (uint32_t layer = range.baseArrayLayer; layer < layerEnd; layer++)
+            {
+                const auto i = level * tracked.layers + layer;
+                auto &queued = tracked.target[i];
+
+                // Nothing was recorded in between, so the earlier transition can be retargeted instead
+                if (tracked.pending[i])
+                {
+                    stats.elided++;
+
+                    if (queued.layout == target.layout && !writes(queued.access) && !writes(target.access))
+                    {
+                        queued.access |= target.access;
+                        queued.stage |= target.stage;
+                        continue;
+                    }
+                }
+
+                queued = target;
+                tracked.pending[i] = true;
+            }
+        }
+
+        if (!tracked.queued)
+        {
+            tracked.queued = true;
+            queuedImages.push_back(image);
+        }
+    }
+
+    void ImageTracker::flush(VkCommandBuffer command)
+    {
+        VkPipelineStageFlags srcStages = 0;
+        VkPipelineStageFlags dstStages = 0;
+        barriers.clear();
+
+        for (const auto image : queuedImages)
+        {
+            auto &tracked = images.at(image);
+            tracked.queued = false;
+
+            for (uint32_t level = 0; level < tracked.levels; level++)
+            {
+                for (uint32_t layer = 0; layer < tracked.layers; layer++)
+                {
+                    const auto i = level * tracked.layers + layer;
+
+                    if (!tracked.pending[i])
+                        continue;
+
+                    tracked.pending[i] = false;
+
+                    auto &current = tracked.current[i];
+                    const auto &target = tracked.target[i];
+
+                    if (current.layout == target.layout && !writes(current.access) && !writes(target.access))
+                    {
+                        // Read after read, later writers still have to wait on every reader
+                        current.access |= target.access;
+                        current.stage |= target.stage;
+                        tracked.target[i] = current;
+                        stats.elided++;
+                        continue;
+                    }
+
+                    srcStages |= current.stage != 0 ? current.stage : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+                    dstStages |= target.stage;
+
+                    // Neighbouring layers, then levels, with the same transition share one barrier
+                    if (!barriers.empty())
+                    {
+                        auto &last = barriers.back();
+                        auto &lastRange = last.subresourceRange;
+
+                        const bool sameTransition = last.image == image &&
+                                                    last.oldLayout == current.layout &&
+                                                    last.newLayout == target.layout &&
+                                                    last.srcAccessMask == (current.access & WriteAccessMask) &&
+                                                    last.dstAccessMask == target.access;
+
+                        if (sameTransition && lastRange.baseMipLevel == level &&
+                            lastRange.baseArrayLayer + lastRange.layerCount == layer)
+                        {
+                            lastRange.layerCount++;
+                            current = target;
+                            continue;
+                        }
+
+                        if (sameTransition && lastRange.baseMipLevel + lastRange.levelCount == level &&
+                            lastRange.baseArrayLayer == 0 && lastRange.layerCount == tracked.layers && layer == 0)
+                        {
+                            // Only whole levels merge, the rest of this level has to match as well
+                            bool wholeLevel = true;
+
+                            for (uint32_t other = 1; other < tracked.layers && wholeLevel; other++)
+                            {
+                                const auto j = level * tracked.layers + other;
+                                wholeLevel = tracked.pending[j] &&
+                                             tracked.current[j].layout == current.layout &&
+                                             tracked.current[j].access == current.access &&
+                                             tracked.current[j].stage == current.stage &&
+                                             tracked.target[j].layout == target.layout &&
+                                             tracked.target[j].access == target.access &&
+                                             tracked.target[j].stage == target.stage;
+                            }
+
+                            if (wholeLevel)
+                            {
+                                for (uint32_t other = 0; other < tracked.layers; other++)
+                                {
+                                    const auto j = level * tracked.layers + other;
+                                    tracked.pending[j] = false;
+                                    tracked.current[j] = tracked.target[j];
+                                }
+
+                                lastRange.levelCount++;
+                                break;
+                            }
+                        }
+                    }
+
+                    auto barrier = Inits::imageMemoryBarrier(image, current.layout, target.layout);
+                    barrier.srcAccessMask = current.access & WriteAccessMask;
+                    barrier.dstAccessMask = target.access;
+                    barrier.subresourceRange.aspectMask = tracked.aspect;
+                    barrier.subresourceRange.baseMipLevel = level;
+                    barrier.subresourceRange.baseArrayLayer = layer;
+                    barriers.push_back(barrier);
+
+                    current = target;
+                }
+            }
+        }
+
+        queuedImages.clear();
+
+        if (barriers.empty())
+            return;
+
+        vkCmdPipelineBarrier(command, srcStages, dstStages, 0, 0, nullptr, 0, nullptr,
+                             uint32_t(barriers.size()), barriers.data());
+
+        stats.issued += uint32_t(barriers.size());
+        stats.flushes++;
+    }
+
+    void ImageTracker::nextFrame()
+    {
+        frameStats = stats;
+        stats = {};
+    }
+
+    bool ImageTracker::writes(VkAccessFlags access)
+    {
+        return (access & WriteAccessMask) != 0;
+    }
+} // vks
@@ -0,0 +1,86 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#pragma once
+
+#include "Base/VulkanInitialisers.hpp"
+
+#include <unordered_map>
+#include <vector>
+
+namespace vks
+{
+    struct ImageState
+    {
+        VkImageLayout           layout;
+        VkAccessFlags           access;
+        VkPipelineStageFlags    stage;
+    };
+
+    // Tracks layout, access and stage per subresource of every registered image, so callers only state
+    // where an image needs to be next. Transitions are queued and recorded by flush() as a single
+    // vkCmdPipelineBarrier, which must happen before the next draw or dispatch that depends on them.
+    // Transitions to the state an image is already in are dropped, as are read-after-read transitions.
+    // State is global, command buffers have to be submitted in the order they were recorded in.
+    class ImageTracker
+    {
+        struct TrackedImage
+        {
+            VkImageAspectFlags          aspect;
+            uint32_t                    levels;
+            uint32_t                    layers;
+            std::vector<ImageState>     current;    // As of the last flush, mip major
+            std::vector<ImageState>     target;
+            std::vector<bool>           pending;
+            bool                        queued;
+        };
+
+    public:
+        struct Stats
+        {
+            uint32_t    issued;         // Image barriers recorded
+            uint32_t    elided;         // Requested transitions that needed no barrier
+            uint32_t    flushes;        // vkCmdPipelineBarrier calls
+        };
+
+        static constexpr VkImageSubresourceRange WholeImage = {
+                0, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS
+        };
+
+        void track(VkImage image,
+                   VkImageAspectFlags aspect,
+                   uint32_t levels = 1,
+                   uint32_t layers = 1,
+                   const ImageState &initial = { VK_IMAGE_LAYOUT_UNDEFINED, 0, 0 });
+
+        void untrack(VkImage image);
+        bool isTracked(VkImage image) const { return images.count(image) != 0; }
+
+        // Overrides the known state without a barrier. An undefined layout discards the contents,
+        // access and stage still order the next transition after earlier users of the memory.
+        void setState(VkImage image, const ImageState &state, const VkImageSubresourceRange &range = WholeImage);
+
+        ImageState getState(VkImage image, uint32_t level = 0, uint32_t layer = 0) const;
+
+        // Queues a transition of the range to target, the aspect of the range is ignored.
+        // Several requests for the same subresource before a flush collapse into one transition.
+        void require(VkImage image, const ImageState &target, const VkImageSubresourceRange &range = WholeImage);
+
+        void flush(VkCommandBuffer command);
+
+        // Publishes the counters of the frame that was just recorded
+        void nextFrame();
+
+        const Stats &getStats() const { return frameStats; }
+
+    private:
+        static bool writes(VkAccessFlags access);
+
+        std::unordered_map<VkImage, TrackedImage>   images;
+        std::vector<VkImage>                        queuedImages;
+        std::vector<VkImageMemoryBarrier>           barriers;
+        Stats                                       stats{};
+        Stats                                       frameStats{};
+    };
+} // vks
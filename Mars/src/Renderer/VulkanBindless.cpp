@@ -0,0 +1,252 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#include "VulkanBindless.hpp"
+
+namespace vks
+{
+    void BindlessSlots::initialise(uint32_t capacity)
+    {
+        slotCapacity = capacity;
+        next = 0;
+        freeSlots.clear();
+        unstamped.clear();
+        pending.clear();
+        acquired.clear();
+    }
+
+    uint32_t BindlessSlots::acquire()
+    {
+        if (!freeSlots.empty())
+        {
+            const auto index = freeSlots.back();
+            freeSlots.pop_back();
+            acquired[index] = 1;
+            return index;
+        }
+
+        if (next == slotCapacity)
+            return INVALID_BINDLESS_INDEX;
+
+        acquired.push_back(1);
+        return next++;
+    }
+
+    bool BindlessSlots::release(uint32_t index)
+    {
+        if (index >= next || !acquired[index])
+            return false;
+
+        acquired[index] = 0;
+        unstamped.push_back(index);
+        return true;
+    }
+
+    void BindlessSlots::stamp(SubmitToken frameToken)
+    {
+        for (const auto index : unstamped)
+            pending.push_back({ index, frameToken });
+
+        unstamped.clear();
+    }
+
+    void BindlessSlots::collect()
+    {
+        while (!pending.empty() && pending.front().token.timeline->isComplete(pending.front().token.value))
+        {
+            freeSlots.push_back(pending.front().index);
+            pending.pop_front();
+        }
+    }
+
+    bool BindlessDescriptors::initialise(VulkanDevice *dev, uint32_t maxTextures, uint32_t maxBuffers)
+    {
+        device = dev;
+        writes = 0;
+        setLayout = VK_NULL_HANDLE;
+        pipelineLayout = VK_NULL_HANDLE;
+        pool = VK_NULL_HANDLE;
+
+        if (!device->extensions.descriptorIndexing)
+        {
+            std::cout << "Bindless descriptors unavailable, device lacks descriptor indexing" << std::endl;
+            return false;
+        }
+
+        const auto &props = device->descriptorIndexingProps;
+        maxTextures = min(maxTextures, props.maxDescriptorSetUpdateAfterBindSampledImages);
+        maxTextures = min(maxTextures, props.maxPerStageDescriptorUpdateAfterBindSampledImages);
+        maxBuffers = min(maxBuffers, props.maxDescriptorSetUpdateAfterBindStorageBuffers);
+        maxBuffers = min(maxBuffers, props.maxPerStageDescriptorUpdateAfterBindStorageBuffers);
+
+        textures.initialise(maxTextures);
+        buffers.initialise(maxBuffers);
+
+        constexpr VkShaderStageFlags Stages = VK_SHADER_STAGE_ALL_GRAPHICS | VK_SHADER_STAGE_COMPUTE_BIT;
+        pushStages = Stages;
+
+        auto textureBinding = Inits::descriptorSetLayoutBinding(TextureBinding, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, Stages);
+        textureBinding.descriptorCount = maxTextures;
+
+        auto bufferBinding = Inits::descriptorSetLayoutBinding(BufferBinding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, Stages);
+        bufferBinding.descriptorCount = maxBuffers;
+
+        const VkDescriptorSetLayoutBinding bindings[] = { textureBinding, bufferBinding };
+
+        // Slots may be empty, and may be rewritten while command buffers using other slots are in flight
+        constexpr VkDescriptorBindingFlagsEXT BindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT |
+                                                             VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT |
+                                                             VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT;
+
+        const VkDescriptorBindingFlagsEXT bindingFlags[] = { BindingFlags, BindingFlags };
+
+        VkDescriptorSetLayoutBindingFlagsCreateInfoEXT flagsInfo{};
+        flagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+        flagsInfo.bindingCount = arraysize32(bindingFlags);
+        flagsInfo.pBindingFlags = bindingFlags;
+
+        auto layoutInfo = Inits::descriptorSetLayoutCreateInfo(bindings);
+        layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+        layoutInfo.pNext = &flagsInfo;
+        vkCreateDescriptorSetLayout(*device, &layoutInfo, nullptr, &setLayout);
+
+        const VkDescriptorPoolSize poolSizes[] = {
+                Inits::descriptorPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, maxTextures),
+                Inits::descriptorPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, maxBuffers)
+        };
+
+        auto poolInfo = Inits::descriptorPoolCreateInfo(poolSizes, 1);
+        poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+        vkCreateDescriptorPool(*device, &poolInfo, nullptr, &pool);
+
+        const auto allocInfo = Inits::descriptorSetAllocateInfo(pool, &setLayout, 1);
+        vkAllocateDescriptorSets(*device, &allocInfo, &set);
+
+        const auto pushRange = Inits::pushConstantRange(pushStages, PushConstantSize);
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &setLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushRange;
+        vkCreatePipelineLayout(*device, &pipelineLayoutInfo, nullptr, &pipelineLayout);
+
+        return true;
+    }
+
+    void BindlessDescriptors::shutdown()
+    {
+        if (pool == VK_NULL_HANDLE)
+            return;
+
+        vkDestroyPipelineLayout(*device, pipelineLayout, nullptr);
+        vkDestroyDescriptorPool(*device, pool, nullptr);
+        vkDestroyDescriptorSetLayout(*device, setLayout, nullptr);
+        pool = VK_NULL_HANDLE;
+    }
+
+    uint32_t BindlessDescriptors::addTexture(VkImageView view, VkSampler sampler, VkImageLayout layout)
+    {
+        uint32_t index = INVALID_BINDLESS_INDEX;
+        {
+            std::lock_guard lock(mutex);
+            index = textures.acquire();
+        }
+
+        if (index == INVALID_BINDLESS_INDEX)
+        {
+            std::cout << "Error, bindless texture array is full (" << textures.capacity() << ")" << std::endl;
+            return index;
+        }
+
+        updateTexture(index, view, sampler, layout);
+        return index;
+    }
+
+    uint32_t BindlessDescriptors::addBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range)
+    {
+        uint32_t index = INVALID_BINDLESS_INDEX;
+        {
+            std::lock_guard lock(mutex);
+            index = buffers.acquire();
+            writes += index != INVALID_BINDLESS_INDEX ? 1 : 0;
+        }
+
+        if (index == INVALID_BINDLESS_INDEX)
+        {
+            std::cout << "Error, bindless buffer array is full (" << buffers.capacity() << ")" << std::endl;
+            return index;
+        }
+
+        const auto bufferInfo = Inits::descriptorBufferInfo(buffer, offset, range);
+        auto write = Inits::writeDescriptorSet(BufferBinding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, set, &bufferInfo);
+        write.dstArrayElement = index;
+        vkUpdateDescriptorSets(*device, 1, &write, 0, nullptr);
+        return index;
+    }
+
+    void BindlessDescriptors::updateTexture(uint32_t index, VkImageView view, VkSampler sampler, VkImageLayout layout)
+    {
+        VkDescriptorImageInfo imageInfo{};
+        imageInfo.imageView = view;
+        imageInfo.sampler = sampler;
+        imageInfo.imageLayout = layout;
+
+        auto write = Inits::writeDescriptorSet(TextureBinding, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, set, &imageInfo);
+        write.dstArrayElement = index;
+        vkUpdateDescriptorSets(*device, 1, &write, 0, nullptr);
+
+        std::lock_guard lock(mutex);
+        writes++;
+    }
+
+    void BindlessDescriptors::removeTexture(uint32_t index)
+    {
+        std::lock_guard lock(mutex);
+
+        if (!textures.release(index))
+            std::cout << "Warning, bindless texture " << index << " is not in use" << std::endl;
+    }
+
+    void BindlessDescriptors::removeBuffer(uint32_t index)
+    {
+        std::lock_guard lock(mutex);
+
+        if (!buffers.release(index))
+            std::cout << "Warning, bindless buffer " << index << " is not in use" << std::endl;
+    }
+
+    void BindlessDescriptors::stamp(SubmitToken frameToken)
+    {
+        std::lock_guard lock(mutex);
+        textures.stamp(frameToken);
+        buffers.stamp(frameToken);
+    }
+
+    void BindlessDescriptors::collect()
+    {
+        std::lock_guard lock(mutex);
+        textures.collect();
+        buffers.collect();
+    }
+
+    void BindlessDescriptors::bind(VkCommandBuffer command, VkPipelineBindPoint bindPoint) const
+    {
+        vkCmdBindDescriptorSets(command, bindPoint, pipelineLayout, 0, 1, &set, 0, nullptr);
+    }
+
+    BindlessDescriptors::Stats BindlessDescriptors::getStats()
+    {
+        std::lock_guard lock(mutex);
+
+        Stats stats{};
+        stats.textures = textures.used();
+        stats.textureCapacity = textures.capacity();
+        stats.buffers = buffers.used();
+        stats.bufferCapacity = buffers.capacity();
+        stats.writes = writes;
+        return stats;
+    }
+} // vks
@@ -0,0 +1,120 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#pragma once
+
+#include "VulkanDevice.hpp"
+
+namespace vks
+{
+    constexpr uint32_t INVALID_BINDLESS_INDEX = UINT32_MAX;
+
+    // Free list of array slots. Released slots only return to the list once the GPU
+    // has finished the work that could still index them: they wait unstamped until the
+    // next frame submission, whose value is handed over through stamp().
+    class BindlessSlots
+    {
+        struct PendingSlot
+        {
+            uint32_t    index;
+            SubmitToken token;
+        };
+
+    public:
+        void initialise(uint32_t slotCapacity);
+
+        uint32_t acquire();
+
+        // False for slots that are not currently acquired, including a second release of the same slot
+        bool release(uint32_t index);
+        void stamp(SubmitToken frameToken);
+        void collect();
+
+        uint32_t capacity() const { return slotCapacity; }
+        uint32_t used() const { return next - uint32_t(freeSlots.size()); }
+
+    private:
+        std::vector<uint32_t>       freeSlots;
+        std::vector<uint32_t>       unstamped;
+        std::deque<PendingSlot>     pending;
+        std::vector<uint8_t>        acquired;       // One flag per slot handed out so far
+        uint32_t                    next;
+        uint32_t                    slotCapacity;
+    };
+
+    // One global, update-after-bind descriptor set holding every texture and storage buffer.
+    // Resources are referenced by their array index, which shaders receive through push constants,
+    // so a command buffer binds the set once and draws never touch descriptors again.
+    //
+    //  layout(set = 0, binding = 0) uniform sampler2D textures[];
+    //  layout(set = 0, binding = 1) buffer Buffers { uint data[]; } buffers[];
+    class BindlessDescriptors
+    {
+    public:
+        static constexpr uint32_t TextureBinding = 0;
+        static constexpr uint32_t BufferBinding = 1;
+
+        // The minimum every device guarantees
+        static constexpr uint32_t PushConstantSize = 128;
+
+        struct Stats
+        {
+            uint32_t    textures;
+            uint32_t    textureCapacity;
+            uint32_t    buffers;
+            uint32_t    bufferCapacity;
+            uint32_t    writes;
+        };
+
+        // Fails when the device lacks descriptor indexing, callers keep per-material sets then
+        bool initialise(VulkanDevice *dev, uint32_t maxTextures = 16384, uint32_t maxBuffers = 4096);
+        void shutdown();
+
+        uint32_t addTexture(VkImageView view, VkSampler sampler,
+                            VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        uint32_t addBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+
+        // Slots in use by the GPU may be rewritten thanks to update-unused-while-pending,
+        // but are only handed out again once the frame submitted after the removal has completed
+        void updateTexture(uint32_t index, VkImageView view, VkSampler sampler,
+                           VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        void removeTexture(uint32_t index);
+        void removeBuffer(uint32_t index);
+
+        // Keys slots removed since the last call to the frame that was just submitted
+        void stamp(SubmitToken frameToken);
+
+        // Recycles released slots, call once per frame
+        void collect();
+
+        void bind(VkCommandBuffer command, VkPipelineBindPoint bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS) const;
+
+        void pushIndices(VkCommandBuffer command, const void *data, uint32_t size) const
+        {
+            Tools::PushConstants(command, pipelineLayout, Inits::pushConstantRange(pushStages, size), data);
+        }
+
+        template<typename T>
+        void pushIndices(VkCommandBuffer command, const T &indices) const
+        {
+            static_assert(sizeof(T) <= PushConstantSize);
+            pushIndices(command, &indices, sizeof(T));
+        }
+
+        Stats getStats();
+
+        VkDescriptorSetLayout       setLayout;
+        VkPipelineLayout            pipelineLayout;     // Shared by every bindless pipeline
+
+    private:
+        VulkanDevice                *device;
+        VkDescriptorPool            pool;
+        VkDescriptorSet             set;
+        VkShaderStageFlags          pushStages;
+        BindlessSlots               textures;
+        BindlessSlots               buffers;
+        std::mutex                  mutex;
+        uint32_t                    writes;
+    };
+} // vks
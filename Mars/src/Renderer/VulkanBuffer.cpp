@@ -0,0 +1,88 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#include "VulkanBuffer.hpp"
+
+namespace vks
+{
+    bool Buffer::create(VulkanDevice *dev,
+                        VkDeviceSize bufferSize,
+                        VkBufferUsageFlags usage,
+                        VkMemoryPropertyFlags required,
+                        VkMemoryPropertyFlags preferred,
+                        const uint32_t *pQueueFamilies,
+                        uint32_t queueFamilyCount)
+    {
+        device = dev;
+        size = bufferSize;
+
+        auto bufferInfo = Inits::bufferCreateInfo(size, usage);
+
+        if (queueFamilyCount > 1)
+        {
+            bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+            bufferInfo.queueFamilyIndexCount = queueFamilyCount;
+            bufferInfo.pQueueFamilyIndices = pQueueFamilies;
+        }
+
+        if (vkCreateBuffer(*device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS)
+        {
+            std::cout << "Error, could not create a buffer of " << size << " bytes" << std::endl;
+            return false;
+        }
+
+        VkMemoryRequirements memReqs;
+        vkGetBufferMemoryRequirements(*device, buffer, &memReqs);
+
+        const auto allocInfo = device->getMemoryAllocInfo(memReqs, required, preferred);
+
+        if (device->allocateMemory(allocInfo, &memory) != VK_SUCCESS)
+        {
+            std::cout << "Error, could not allocate " << memReqs.size << " bytes for a buffer" << std::endl;
+            vkDestroyBuffer(*device, buffer, nullptr);
+            buffer = VK_NULL_HANDLE;
+            return false;
+        }
+
+        vkBindBufferMemory(*device, buffer, memory, 0);
+
+        const auto flags = device->memProps.memoryTypes[allocInfo.memoryTypeIndex].propertyFlags;
+        coherent = (flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+        mapped = nullptr;
+
+        if (flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+            vkMapMemory(*device, memory, 0, VK_WHOLE_SIZE, 0, &mapped);
+
+        return true;
+    }
+
+    void Buffer::destroy()
+    {
+        if (device == nullptr)
+            return;
+
+        // Freeing the memory implicitly unmaps it
+        device->deletionQueue.push(buffer);
+        device->deletionQueue.push(memory);
+        buffer = VK_NULL_HANDLE;
+        memory = VK_NULL_HANDLE;
+        mapped = nullptr;
+    }
+
+    void Buffer::flush(VkDeviceSize offset, VkDeviceSize range)
+    {
+        if (coherent || mapped == nullptr)
+            return;
+
+        // Ranges have to be aligned to the atom size, the allocation itself always is
+        const auto atom = device->gpuProperties.limits.nonCoherentAtomSize;
+
+        VkMappedMemoryRange memoryRange{};
+        memoryRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+        memoryRange.memory = memory;
+        memoryRange.offset = offset - offset % atom;
+        memoryRange.size = range == VK_WHOLE_SIZE ? VK_WHOLE_SIZE : (offset + range - memoryRange.offset + atom - 1) / atom * atom;
+        vkFlushMappedMemoryRanges(*device, 1, &memoryRange);
+    }
+} // vks
@@ -0,0 +1,49 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#pragma once
+
+#include "VulkanDevice.hpp"
+
+namespace vks
+{
+    // A buffer with its own allocation. Host visible buffers stay mapped for their whole lifetime.
+    class Buffer
+    {
+    public:
+        constexpr operator VkBuffer() const
+        {
+            return buffer;
+        }
+
+        // Concurrent sharing over the given families when more than one is passed
+        bool create(VulkanDevice *dev,
+                    VkDeviceSize bufferSize,
+                    VkBufferUsageFlags usage,
+                    VkMemoryPropertyFlags required,
+                    VkMemoryPropertyFlags preferred = 0,
+                    const uint32_t *pQueueFamilies = nullptr,
+                    uint32_t queueFamilyCount = 0);
+
+        // Deferred until the GPU is done with it
+        void destroy();
+
+        // Makes host writes visible, a no-op on coherent memory
+        void flush(VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+
+        template<typename T>
+        T *data() const { return static_cast<T*>(mapped); }
+
+        VkDeviceSize getSize() const { return size; }
+        bool isMapped() const { return mapped != nullptr; }
+
+    private:
+        VulkanDevice        *device = nullptr;
+        VkBuffer            buffer = VK_NULL_HANDLE;
+        VkDeviceMemory      memory = VK_NULL_HANDLE;
+        VkDeviceSize        size = 0;
+        void                *mapped = nullptr;
+        bool                coherent = true;
+    };
+} // vks
@@ -0,0 +1,171 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#include "VulkanCommandPools.hpp"
+
+#include <iostream>
+
+namespace vks
+{
+    void FencePool::initialise(VkDevice dev)
+    {
+        device = dev;
+        created = 0;
+    }
+
+    void FencePool::shutdown()
+    {
+        for (auto fence : freeFences)
+            vkDestroyFence(device, fence, nullptr);
+
+        freeFences.clear();
+    }
+
+    VkFence FencePool::acquire()
+    {
+        std::lock_guard lock(mutex);
+
+        if (!freeFences.empty())
+        {
+            const auto fence = freeFences.back();
+            freeFences.pop_back();
+            return fence;
+        }
+
+        const auto fenceInfo = Inits::fenceCreateInfo(0);
+        VkFence fence = VK_NULL_HANDLE;
+        vkCreateFence(device, &fenceInfo, nullptr, &fence);
+        created++;
+        return fence;
+    }
+
+    void FencePool::recycle(VkFence fence)
+    {
+        vkResetFences(device, 1, &fence);
+
+        std::lock_guard lock(mutex);
+        freeFences.push_back(fence);
+    }
+
+    void CommandPools::initialise(VkDevice dev, uint32_t family)
+    {
+        device = dev;
+        queueFamily = family;
+        stats = {};
+    }
+
+    void CommandPools::shutdown()
+    {
+        if (!owners.empty())
+            std::cout << "Warning, " << owners.size() << " transient command buffers were never released" << std::endl;
+
+        for (auto &[id, thread] : threads)
+        {
+            for (auto &page : thread.pages)
+                vkDestroyCommandPool(device, page.pool, nullptr);
+        }
+
+        threads.clear();
+        owners.clear();
+    }
+
+    VkCommandBuffer CommandPools::allocate(VkCommandBufferLevel level)
+    {
+        auto &thread = threadPools();
+        auto *page = thread.current;
+
+        // Only the owning thread allocates from a page, so an idle page can be recycled in place
+        if (page != nullptr && page->outstanding == 0)
+            resetPage(*page);
+
+        if (page == nullptr || page->next[level] == PageCapacity)
+            page = thread.current = &acquirePage(thread);
+
+        auto &buffers = page->buffers[level];
+        const bool grow = page->next[level] == buffers.size();
+
+        if (grow)
+        {
+            VkCommandBuffer command = VK_NULL_HANDLE;
+            auto allocateInfo = Inits::commandBufferAllocateInfo(page->pool, 1);
+            allocateInfo.level = level;
+            vkAllocateCommandBuffers(device, &allocateInfo, &command);
+            buffers.push_back(command);
+        }
+
+        const auto command = buffers[page->next[level]++];
+        page->outstanding++;
+
+        std::lock_guard lock(mutex);
+        owners[command] = page;
+
+        if (grow)
+            stats.commandBuffers++;
+
+        return command;
+    }
+
+    void CommandPools::release(VkCommandBuffer command)
+    {
+        std::lock_guard lock(mutex);
+
+        const auto it = owners.find(command);
+        if (it == owners.end())
+            return;
+
+        it->second->outstanding--;
+        owners.erase(it);
+    }
+
+    CommandPools::Stats CommandPools::getStats()
+    {
+        std::lock_guard lock(mutex);
+        return stats;
+    }
+
+    CommandPools::ThreadPools &CommandPools::threadPools()
+    {
+        std::lock_guard lock(mutex);
+
+        auto &thread = threads[std::this_thread::get_id()];
+        return thread;
+    }
+
+    CommandPools::CommandPage &CommandPools::acquirePage(ThreadPools &thread)
+    {
+        for (auto &page : thread.pages)
+        {
+            if (&page != thread.current && page.outstanding == 0)
+            {
+                resetPage(page);
+                return page;
+            }
+        }
+
+        auto &page = thread.pages.emplace_back();
+        page.next[0] = page.next[1] = 0;
+        page.outstanding = 0;
+
+        auto poolInfo = Inits::commandPoolCreateInfo(queueFamily);
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        vkCreateCommandPool(device, &poolInfo, nullptr, &page.pool);
+
+        std::lock_guard lock(mutex);
+        stats.pools++;
+        return page;
+    }
+
+    void CommandPools::resetPage(CommandPage &page)
+    {
+        if (page.next[0] == 0 && page.next[1] == 0)
+            return;
+
+        // Returns every buffer of the page to the initial state in one call
+        vkResetCommandPool(device, page.pool, 0);
+        page.next[0] = page.next[1] = 0;
+
+        std::lock_guard lock(mutex);
+        stats.poolResets++;
+    }
+} // vks
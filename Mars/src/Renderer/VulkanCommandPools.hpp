@@ -0,0 +1,85 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#pragma once
+
+#include "Base/VulkanInitialisers.hpp"
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace vks
+{
+    // Recycles signalled fences instead of creating one per submission
+    class FencePool
+    {
+    public:
+        void initialise(VkDevice dev);
+        void shutdown();
+
+        VkFence acquire();
+        void recycle(VkFence fence);
+
+        uint32_t createdCount() const { return created; }
+
+    private:
+        VkDevice                device;
+        std::vector<VkFence>    freeFences;
+        std::mutex              mutex;
+        uint32_t                created;
+    };
+
+    // Per-thread transient command pools. Each thread allocates linearly from a page and a page
+    // is reset in bulk with vkResetCommandPool once every buffer handed out from it was released.
+    // A buffer that is never released pins its page until shutdown, which warns about it.
+    class CommandPools
+    {
+        static constexpr uint32_t PageCapacity = 32;
+
+        struct CommandPage
+        {
+            VkCommandPool                   pool;
+            std::vector<VkCommandBuffer>    buffers[2];
+            uint32_t                        next[2];
+            std::atomic<uint32_t>           outstanding;
+        };
+
+        struct ThreadPools
+        {
+            std::deque<CommandPage>         pages;
+            CommandPage                     *current;
+        };
+
+    public:
+        struct Stats
+        {
+            uint32_t pools;
+            uint32_t commandBuffers;
+            uint32_t poolResets;
+        };
+
+        void initialise(VkDevice dev, uint32_t family);
+        void shutdown();
+
+        VkCommandBuffer allocate(VkCommandBufferLevel level);
+        void release(VkCommandBuffer command);
+
+        Stats getStats();
+
+    private:
+        ThreadPools &threadPools();
+        CommandPage &acquirePage(ThreadPools &thread);
+        void resetPage(CommandPage &page);
+
+        VkDevice                                            device;
+        uint32_t                                            queueFamily;
+        std::unordered_map<std::thread::id, ThreadPools>    threads;
+        std::unordered_map<VkCommandBuffer, CommandPage*>   owners;
+        std::mutex                                          mutex;
+        Stats                                               stats;
+    };
+} // vks
@@ -0,0 +1,232 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#include "VulkanCompute.hpp"
+
+namespace vks
+{
+    bool ComputeKernel::create(VulkanDevice *dev,
+                               VkShaderModule module,
+                               const VkDescriptorSetLayout *pSetLayouts,
+                               uint32_t setLayoutCount,
+                               uint32_t pushConstantSize,
+                               const VkSpecializationInfo *pSpecialization)
+    {
+        device = dev;
+        pushSize = pushConstantSize;
+
+        const auto pushRange = Inits::pushConstantRange(VK_SHADER_STAGE_COMPUTE_BIT, pushConstantSize);
+
+        VkPipelineLayoutCreateInfo layoutInfo{};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        layoutInfo.setLayoutCount = setLayoutCount;
+        layoutInfo.pSetLayouts = pSetLayouts;
+        layoutInfo.pushConstantRangeCount = pushConstantSize > 0 ? 1 : 0;
+        layoutInfo.pPushConstantRanges = &pushRange;
+
+        if (vkCreatePipelineLayout(*device, &layoutInfo, nullptr, &layout) != VK_SUCCESS)
+        {
+            std::cout << "Error, could not create compute pipeline layout" << std::endl;
+            return false;
+        }
+
+        VkComputePipelineCreateInfo pipelineInfo{};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.stage = Inits::shaderStageInfo(VK_SHADER_STAGE_COMPUTE_BIT, module);
+        pipelineInfo.stage.pSpecializationInfo = pSpecialization;
+        pipelineInfo.layout = layout;
+
+        if (device->createComputePipeline(pipelineInfo, &pipeline) != VK_SUCCESS)
+        {
+            std::cout << "Error, could not create compute pipeline" << std::endl;
+            vkDestroyPipelineLayout(*device, layout, nullptr);
+            layout = VK_NULL_HANDLE;
+            return false;
+        }
+
+        return true;
+    }
+
+    void ComputeKernel::destroy()
+    {
+        if (device == nullptr)
+            return;
+
+        device->deletionQueue.push(pipeline);
+        device->deletionQueue.push(layout);
+        pipeline = VK_NULL_HANDLE;
+        layout = VK_NULL_HANDLE;
+    }
+
+    void ComputeKernel::bind(VkCommandBuffer command, const VkDescriptorSet *pSets, uint32_t setCount, uint32_t firstSet) const
+    {
+        vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+
+        if (setCount > 0)
+            vkCmdBindDescriptorSets(command, VK_PIPELINE_BIND_POINT_COMPUTE, layout, firstSet, setCount, pSets, 0, nullptr);
+    }
+
+    void ComputeKernel::push(VkCommandBuffer command, const void *data) const
+    {
+        Tools::PushConstants(command, layout, Inits::pushConstantRange(VK_SHADER_STAGE_COMPUTE_BIT, pushSize), data);
+    }
+
+    void AsyncCompute::initialise(VulkanDevice *dev, uint32_t frameCount)
+    {
+        device = dev;
+        framesInFlight = frameCount;
+        current = 0;
+        async = device->asyncCompute();
+        stats = {};
+
+        for (uint32_t i = 0; i < framesInFlight; i++)
+        {
+            auto &frame = frames[i];
+            frame = {};
+
+            auto poolInfo = Inits::commandPoolCreateInfo(device->indices.compute);
+            poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+            vkCreateCommandPool(*device, &poolInfo, nullptr, &frame.pool);
+
+            auto cmdInfo = Inits::commandBufferAllocateInfo(frame.pool, 1);
+            vkAllocateCommandBuffers(*device, &cmdInfo, &frame.command);
+        }
+    }
+
+    void AsyncCompute::shutdown()
+    {
+        auto &timeline = getTimeline();
+        timeline.wait(timeline.lastSubmitted());
+
+        for (uint32_t i = 0; i < framesInFlight; i++)
+            vkDestroyCommandPool(*device, frames[i].pool, nullptr);
+    }
+
+    uint32_t AsyncCompute::getQueueFamilies(uint32_t (&families)[2]) const
+    {
+        families[0] = device->indices.graphics;
+        families[1] = device->indices.compute;
+        return async ? 2 : 1;
+    }
+
+    VkCommandBuffer AsyncCompute::begin(uint32_t frame)
+    {
+        auto &slot = frames[frame];
+        current = frame;
+
+        // Normally long done, the graphics work of the slot waited on it
+        getTimeline().wait(slot.value);
+        vkResetCommandPool(*device, slot.pool, 0);
+
+        const auto beginInfo = Inits::commandBufferBeginInfo(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+        vkBeginCommandBuffer(slot.command, &beginInfo);
+
+        // Inline work has no semaphore to wait on, so earlier graphics writes it may read are made visible here
+        if (!async)
+        {
+            VkMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+                                    VK_ACCESS_SHADER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+            vkCmdPipelineBarrier(slot.command, VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+        }
+
+        slot.recording = true;
+        return slot.command;
+    }
+
+    uint64_t AsyncCompute::submit(VkPipelineStageFlags consumerStages, uint64_t afterGraphics)
+    {
+        auto &slot = frames[current];
+
+        if (!slot.recording)
+            return slot.value;
+
+        // Same queue and same submission, a barrier orders the graphics work recorded after it
+        if (!async)
+        {
+            VkMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            barrier.dstAccessMask = consumerAccess(consumerStages);
+            vkCmdPipelineBarrier(slot.command, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, consumerStages,
+                                 0, 1, &barrier, 0, nullptr, 0, nullptr);
+        }
+
+        vkEndCommandBuffer(slot.command);
+        slot.recording = false;
+        slot.consumerStages = consumerStages;
+        stats.submissions++;
+
+        // Submitting it separately would only cost another vkQueueSubmit per frame
+        if (!async)
+        {
+            slot.inlined = true;
+            stats.inlineSubmissions++;
+            return 0;
+        }
+
+        TimelineSubmitInfo submitInfo{};
+        submitInfo.pCommandBuffers = &slot.command;
+        submitInfo.commandBufferCount = 1;
+
+        if (afterGraphics > 0)
+            submitInfo.waits[submitInfo.waitCount++] = { &device->graphicsTimeline, afterGraphics, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT };
+
+        slot.value = getTimeline().submit(submitInfo);
+        slot.submitted = true;
+        stats.asyncSubmissions++;
+        return slot.value;
+    }
+
+    VkAccessFlags AsyncCompute::consumerAccess(VkPipelineStageFlags consumerStages)
+    {
+        constexpr VkPipelineStageFlags ShaderStages = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                                                      VK_PIPELINE_STAGE_TESSELLATION_CONTROL_SHADER_BIT |
+                                                      VK_PIPELINE_STAGE_TESSELLATION_EVALUATION_SHADER_BIT |
+                                                      VK_PIPELINE_STAGE_GEOMETRY_SHADER_BIT |
+                                                      VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                                                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+        VkAccessFlags access = 0;
+
+        if (consumerStages & VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT)
+            access |= VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+
+        if (consumerStages & VK_PIPELINE_STAGE_VERTEX_INPUT_BIT)
+            access |= VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+
+        if (consumerStages & ShaderStages)
+            access |= VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+
+        return access;
+    }
+
+    bool AsyncCompute::takeWait(uint32_t frame, TimelineWait &wait)
+    {
+        auto &slot = frames[frame];
+
+        if (!slot.submitted)
+            return false;
+
+        slot.submitted = false;
+        wait = { &getTimeline(), slot.value, slot.consumerStages };
+        stats.graphicsWaits++;
+        return true;
+    }
+
+    bool AsyncCompute::takeInline(uint32_t frame, VkCommandBuffer &command)
+    {
+        auto &slot = frames[frame];
+
+        if (!slot.inlined)
+            return false;
+
+        slot.inlined = false;
+        command = slot.command;
+        return true;
+    }
+} // vks
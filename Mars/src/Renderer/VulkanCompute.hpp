@@ -0,0 +1,133 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#pragma once
+
+#include "VulkanDevice.hpp"
+
+namespace vks
+{
+    // A compute pipeline and its layout. Culling, particle simulation and post-processing passes all
+    // reduce to binding one of these, pushing constants and dispatching.
+    class ComputeKernel
+    {
+    public:
+        bool create(VulkanDevice *dev,
+                    VkShaderModule module,
+                    const VkDescriptorSetLayout *pSetLayouts,
+                    uint32_t setLayoutCount,
+                    uint32_t pushConstantSize = 0,
+                    const VkSpecializationInfo *pSpecialization = nullptr);
+
+        // Deferred until the GPU is done with it
+        void destroy();
+
+        void bind(VkCommandBuffer command,
+                  const VkDescriptorSet *pSets = nullptr,
+                  uint32_t setCount = 0,
+                  uint32_t firstSet = 0) const;
+
+        // Pushes pushConstantSize bytes
+        void push(VkCommandBuffer command, const void *data) const;
+
+        template<typename T>
+        void push(VkCommandBuffer command, const T &constants) const
+        {
+            push(command, static_cast<const void*>(&constants));
+        }
+
+        void dispatch(VkCommandBuffer command, uint32_t x, uint32_t y = 1, uint32_t z = 1) const
+        {
+            vkCmdDispatch(command, x, y, z);
+        }
+
+        // One invocation per item, groupSize has to match the shader's local size
+        void dispatchItems(VkCommandBuffer command, uint32_t itemCount, uint32_t groupSize) const
+        {
+            vkCmdDispatch(command, (itemCount + groupSize - 1) / groupSize, 1, 1);
+        }
+
+        VkPipeline getPipeline() const { return pipeline; }
+        VkPipelineLayout getLayout() const { return layout; }
+
+    private:
+        VulkanDevice        *device = nullptr;
+        VkPipeline          pipeline = VK_NULL_HANDLE;
+        VkPipelineLayout    layout = VK_NULL_HANDLE;
+        uint32_t            pushSize = 0;
+    };
+
+    // One compute command buffer per frame in flight, submitted ahead of the frame's graphics work.
+    // With a dedicated compute family it runs on its own queue and overlaps with the rasterisation of
+    // the previous frame, the graphics submission waits on its timeline value. Without one the command
+    // buffer is handed to the frame's own graphics submission ahead of the frame's commands and ends in
+    // a barrier instead, no separate submission is made.
+    // Resources used on both queues have to be created with VK_SHARING_MODE_CONCURRENT over
+    // getQueueFamilies(), no ownership transfers are recorded.
+    class AsyncCompute
+    {
+        struct Frame
+        {
+            VkCommandPool           pool;
+            VkCommandBuffer         command;
+            uint64_t                value;
+            VkPipelineStageFlags    consumerStages;
+            bool                    recording;
+            bool                    submitted;      // Not yet waited on by a graphics submission
+            bool                    inlined;        // Not yet taken into the frame's graphics submission
+        };
+
+    public:
+        // Where graphics work typically consumes compute results: indirect arguments, vertex data, shaders
+        static constexpr VkPipelineStageFlags DefaultConsumerStages = VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+                                                                      VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+                                                                      VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                                                                      VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+        struct Stats
+        {
+            uint32_t    submissions;
+            uint32_t    asyncSubmissions;   // Ran on the dedicated compute queue
+            uint32_t    inlineSubmissions;  // Went into the frame's graphics submission
+            uint32_t    graphicsWaits;      // Graphics submissions that waited on compute
+        };
+
+        void initialise(VulkanDevice *dev, uint32_t frameCount);
+        void shutdown();
+
+        bool isAsync() const { return async; }
+
+        QueueTimeline &getTimeline() const { return device->getTimeline(device->computeQueue); }
+
+        // For VK_SHARING_MODE_CONCURRENT, returns 1 when compute and graphics share a family
+        uint32_t getQueueFamilies(uint32_t (&families)[2]) const;
+
+        // Begins the frame slot's command buffer, the slot's previous submission has completed
+        VkCommandBuffer begin(uint32_t frame);
+
+        // consumerStages are the graphics stages reading the results. afterGraphics is a graphics timeline
+        // value the compute work has to wait for, e.g. when it reads the previous frame's depth, zero for none.
+        // Returns the compute timeline value, zero when the work goes inline into the frame's submission.
+        uint64_t submit(VkPipelineStageFlags consumerStages = DefaultConsumerStages, uint64_t afterGraphics = 0);
+
+        // Called when the frame's graphics work is submitted, false when there is nothing to wait on
+        bool takeWait(uint32_t frame, TimelineWait &wait);
+
+        // Called when the frame's graphics work is submitted, false when there is no inline command buffer
+        bool takeInline(uint32_t frame, VkCommandBuffer &command);
+
+        const Stats &getStats() const { return stats; }
+
+    private:
+        // Reads the given graphics stages can make, barriers may only name accesses their stages support
+        static VkAccessFlags consumerAccess(VkPipelineStageFlags consumerStages);
+
+        VulkanDevice    *device;
+        Frame           frames[MAX_IMAGES_IN_FLIGHT];
+        uint32_t        framesInFlight;
+        uint32_t        current;
+        bool            async;
+        Stats           stats;
+    };
+} // vks
@@ -0,0 +1,99 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#include "VulkanDeletionQueue.hpp"
+#include "VulkanDevice.hpp"
+
+namespace vks
+{
+    void DeletionQueue::initialise(VulkanDevice *dev)
+    {
+        device = dev;
+        stats = {};
+    }
+
+    void DeletionQueue::shutdown()
+    {
+        std::lock_guard lock(mutex);
+
+        for (const auto &entry : entries)
+            destroy(entry);
+
+        for (const auto &entry : unstamped)
+            destroy(entry);
+
+        stats.destroyed += uint32_t(entries.size() + unstamped.size());
+        entries.clear();
+        unstamped.clear();
+    }
+
+    void DeletionQueue::collect()
+    {
+        auto ready = std::vector<Entry>();
+        {
+            std::lock_guard lock(mutex);
+
+            // Values from different queues interleave, so every entry is checked rather than stopping early
+            for (auto it = entries.begin(); it != entries.end();)
+            {
+                if (it->token.timeline->isComplete(it->token.value))
+                {
+                    ready.push_back(*it);
+                    it = entries.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+
+            stats.destroyed += uint32_t(ready.size());
+        }
+
+        for (const auto &entry : ready)
+            destroy(entry);
+    }
+
+    DeletionQueue::Stats DeletionQueue::getStats()
+    {
+        std::lock_guard lock(mutex);
+        return stats;
+    }
+
+    void DeletionQueue::stamp(SubmitToken frameToken)
+    {
+        std::lock_guard lock(mutex);
+
+        for (auto &entry : unstamped)
+        {
+            entry.token = frameToken;
+            entries.push_back(entry);
+        }
+
+        unstamped.clear();
+    }
+
+    void DeletionQueue::destroy(const Entry &entry)
+    {
+        const VkDevice dev = *device;
+
+        switch (entry.kind)
+        {
+            case Kind::Image: vkDestroyImage(dev, reinterpret_cast<VkImage>(entry.handle), nullptr); break;
+            case Kind::ImageView: vkDestroyImageView(dev, reinterpret_cast<VkImageView>(entry.handle), nullptr); break;
+            case Kind::Buffer: vkDestroyBuffer(dev, reinterpret_cast<VkBuffer>(entry.handle), nullptr); break;
+            case Kind::BufferView: vkDestroyBufferView(dev, reinterpret_cast<VkBufferView>(entry.handle), nullptr); break;
+            case Kind::Framebuffer: vkDestroyFramebuffer(dev, reinterpret_cast<VkFramebuffer>(entry.handle), nullptr); break;
+            case Kind::RenderPass: vkDestroyRenderPass(dev, reinterpret_cast<VkRenderPass>(entry.handle), nullptr); break;
+            case Kind::Swapchain: vkDestroySwapchainKHR(dev, reinterpret_cast<VkSwapchainKHR>(entry.handle), nullptr); break;
+            case Kind::Pipeline: vkDestroyPipeline(dev, reinterpret_cast<VkPipeline>(entry.handle), nullptr); break;
+            case Kind::PipelineLayout: vkDestroyPipelineLayout(dev, reinterpret_cast<VkPipelineLayout>(entry.handle), nullptr); break;
+            case Kind::Sampler: vkDestroySampler(dev, reinterpret_cast<VkSampler>(entry.handle), nullptr); break;
+            case Kind::DescriptorPool: vkDestroyDescriptorPool(dev, reinterpret_cast<VkDescriptorPool>(entry.handle), nullptr); break;
+            case Kind::ShaderModule: vkDestroyShaderModule(dev, reinterpret_cast<VkShaderModule>(entry.handle), nullptr); break;
+            case Kind::QueryPool: vkDestroyQueryPool(dev, reinterpret_cast<VkQueryPool>(entry.handle), nullptr); break;
+            case Kind::Memory: device->freeMemory(reinterpret_cast<VkDeviceMemory>(entry.handle)); break;
+        }
+    }
+} // vks
@@ -0,0 +1,121 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#pragma once
+
+#include "VulkanTimeline.hpp"
+
+namespace vks
+{
+    class VulkanDevice;
+
+    // Waitable handle returned by VulkanDevice::submitOneShot, a value on the queue's timeline
+    struct SubmitToken
+    {
+        QueueTimeline   *timeline;
+        uint64_t        value;
+    };
+
+    // Defers destruction until the GPU is done with an object instead of waiting for the device to idle.
+    // Each object is keyed to a timeline value. Objects pushed without one wait for the frame currently
+    // being recorded: VulkanInstance::submitFrame stamps them with the value its submission returned,
+    // since other graphics submissions made in between would make any predicted value wrong.
+    class DeletionQueue
+    {
+        enum class Kind : uint32_t
+        {
+            Image,
+            ImageView,
+            Buffer,
+            BufferView,
+            Framebuffer,
+            RenderPass,
+            Swapchain,
+            Pipeline,
+            PipelineLayout,
+            Sampler,
+            DescriptorPool,
+            ShaderModule,
+            QueryPool,
+            Memory
+        };
+
+        struct Entry
+        {
+            SubmitToken token;
+            Kind        kind;
+            uint64_t    handle;
+        };
+
+    public:
+        struct Stats
+        {
+            uint32_t    queued;
+            uint32_t    destroyed;
+            uint32_t    peak;               // Most objects waiting at once
+        };
+
+        void initialise(VulkanDevice *dev);
+
+        // Destroys everything regardless of GPU progress, the caller must have waited on every queue
+        void shutdown();
+
+        void push(VkImage image, SubmitToken token)                     { enqueue(Kind::Image, image, token); }
+        void push(VkImageView view, SubmitToken token)                  { enqueue(Kind::ImageView, view, token); }
+        void push(VkBuffer buffer, SubmitToken token)                   { enqueue(Kind::Buffer, buffer, token); }
+        void push(VkBufferView view, SubmitToken token)                 { enqueue(Kind::BufferView, view, token); }
+        void push(VkFramebuffer framebuffer, SubmitToken token)         { enqueue(Kind::Framebuffer, framebuffer, token); }
+        void push(VkRenderPass renderPass, SubmitToken token)           { enqueue(Kind::RenderPass, renderPass, token); }
+        void push(VkSwapchainKHR swapchain, SubmitToken token)          { enqueue(Kind::Swapchain, swapchain, token); }
+        void push(VkPipeline pipeline, SubmitToken token)               { enqueue(Kind::Pipeline, pipeline, token); }
+        void push(VkPipelineLayout layout, SubmitToken token)           { enqueue(Kind::PipelineLayout, layout, token); }
+        void push(VkSampler sampler, SubmitToken token)                 { enqueue(Kind::Sampler, sampler, token); }
+        void push(VkDescriptorPool pool, SubmitToken token)             { enqueue(Kind::DescriptorPool, pool, token); }
+        void push(VkShaderModule module, SubmitToken token)             { enqueue(Kind::ShaderModule, module, token); }
+        void push(VkQueryPool pool, SubmitToken token)                  { enqueue(Kind::QueryPool, pool, token); }
+        void push(VkDeviceMemory memory, SubmitToken token)             { enqueue(Kind::Memory, memory, token); }
+
+        // Keyed to the next frame submission
+        template<typename T>
+        void push(T handle)
+        {
+            push(handle, SubmitToken{ nullptr, 0 });
+        }
+
+        // Keys every object pushed without a token to the frame that was just submitted
+        void stamp(SubmitToken frameToken);
+
+        // Destroys every object whose timeline value has completed, never blocks
+        void collect();
+
+        Stats getStats();
+
+    private:
+        template<typename T>
+        void enqueue(Kind kind, T handle, SubmitToken token)
+        {
+            if (handle == VK_NULL_HANDLE)
+                return;
+
+            std::lock_guard lock(mutex);
+            const auto entry = Entry{ token, kind, reinterpret_cast<uint64_t>(handle) };
+
+            if (token.timeline != nullptr)
+                entries.push_back(entry);
+            else
+                unstamped.push_back(entry);
+
+            stats.queued++;
+            stats.peak = max(stats.peak, uint32_t(entries.size() + unstamped.size()));
+        }
+
+        void destroy(const Entry &entry);
+
+        VulkanDevice        *device;
+        std::deque<Entry>   entries;
+        std::vector<Entry>  unstamped;      // Waiting for the next frame's value
+        std::mutex          mutex;
+        Stats               stats;
+    };
+} // vks
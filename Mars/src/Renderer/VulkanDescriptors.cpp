@@ -0,0 +1,255 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#include "VulkanDescriptors.hpp"
+
+#include <algorithm>
+
+namespace vks
+{
+    void DescriptorLayoutCache::initialise(VkDevice dev)
+    {
+        device = dev;
+    }
+
+    void DescriptorLayoutCache::shutdown()
+    {
+        for (auto &[key, cached] : layouts)
+            vkDestroyDescriptorSetLayout(device, cached.layout, nullptr);
+
+        layouts.clear();
+        infos.clear();
+    }
+
+    VkDescriptorSetLayout DescriptorLayoutCache::getLayout(const VkDescriptorSetLayoutBinding *pBindings, uint32_t bindingCount)
+    {
+        // Binding order does not change the layout, so hash them sorted
+        auto bindings = std::vector<VkDescriptorSetLayoutBinding>(pBindings, pBindings + bindingCount);
+        std::sort(bindings.begin(), bindings.end(), [](const auto &a, const auto &b) {
+            return a.binding < b.binding;
+        });
+
+        uint64_t hash = FNV_OFFSET_BASIS;
+        LayoutInfo info{};
+        std::vector<VkSampler> samplers;
+
+        for (const auto &binding : bindings)
+        {
+            const uint32_t fields[] = { binding.binding, uint32_t(binding.descriptorType),
+                                        binding.descriptorCount, binding.stageFlags };
+            hash = HashBytes(fields, sizeof(fields), hash);
+
+            if (binding.pImmutableSamplers != nullptr)
+            {
+                hash = HashBytes(binding.pImmutableSamplers, binding.descriptorCount * sizeof(VkSampler), hash);
+                samplers.insert(samplers.end(), binding.pImmutableSamplers, binding.pImmutableSamplers + binding.descriptorCount);
+            }
+
+            if (binding.descriptorType < DESCRIPTOR_TYPE_COUNT)
+                info.descriptorCounts[binding.descriptorType] += binding.descriptorCount;
+        }
+
+        std::lock_guard lock(mutex);
+
+        const auto [first, last] = layouts.equal_range(hash);
+
+        for (auto it = first; it != last; ++it)
+        {
+            if (sameBindings(it->second, bindings, samplers))
+                return it->second.layout;
+        }
+
+        const auto layoutInfo = Inits::descriptorSetLayoutCreateInfo(bindings.data(), bindings.size());
+
+        VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+        vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &layout);
+
+        layouts.emplace(hash, CachedLayout{ layout, std::move(bindings), std::move(samplers) });
+        infos[layout] = info;
+        return layout;
+    }
+
+    bool DescriptorLayoutCache::sameBindings(const CachedLayout &cached,
+                                             const std::vector<VkDescriptorSetLayoutBinding> &bindings,
+                                             const std::vector<VkSampler> &samplers)
+    {
+        if (cached.bindings.size() != bindings.size() || cached.samplers != samplers)
+            return false;
+
+        for (size_t i = 0; i < bindings.size(); i++)
+        {
+            const auto &a = cached.bindings[i];
+            const auto &b = bindings[i];
+
+            if (a.binding != b.binding || a.descriptorType != b.descriptorType ||
+                a.descriptorCount != b.descriptorCount || a.stageFlags != b.stageFlags ||
+                (a.pImmutableSamplers != nullptr) != (b.pImmutableSamplers != nullptr))
+                return false;
+        }
+
+        return true;
+    }
+
+    DescriptorLayoutCache::LayoutInfo DescriptorLayoutCache::getInfo(VkDescriptorSetLayout layout)
+    {
+        std::lock_guard lock(mutex);
+
+        const auto it = infos.find(layout);
+        return it != infos.end() ? it->second : LayoutInfo{};
+    }
+
+    uint32_t DescriptorLayoutCache::layoutCount()
+    {
+        std::lock_guard lock(mutex);
+        return uint32_t(layouts.size());
+    }
+
+    void DescriptorAllocator::initialise(VulkanDevice *dev, DescriptorLayoutCache *layoutCache)
+    {
+        device = dev;
+        layouts = layoutCache;
+        current = VK_NULL_HANDLE;
+        observedSets = 0;
+        stats = {};
+        stats.setsPerPool = InitialSetsPerPool;
+
+        for (auto &count : observedCounts)
+            count = 0;
+    }
+
+    void DescriptorAllocator::shutdown()
+    {
+        for (auto pool : allPools)
+            vkDestroyDescriptorPool(*device, pool, nullptr);
+
+        allPools.clear();
+        freePools.clear();
+        used.clear();
+        retired.clear();
+        current = VK_NULL_HANDLE;
+    }
+
+    VkDescriptorSet DescriptorAllocator::allocate(VkDescriptorSetLayout layout)
+    {
+        const auto info = layouts->getInfo(layout);
+
+        std::lock_guard lock(mutex);
+
+        observedSets++;
+        for (uint32_t i = 0; i < DESCRIPTOR_TYPE_COUNT; i++)
+            observedCounts[i] += info.descriptorCounts[i];
+
+        if (current == VK_NULL_HANDLE)
+            current = acquirePool();
+
+        VkDescriptorSet set = VK_NULL_HANDLE;
+        auto allocInfo = Inits::descriptorSetAllocateInfo(current, &layout, 1);
+        auto result = vkAllocateDescriptorSets(*device, &allocInfo, &set);
+
+        // Exhausted, chain a fresh pool and retry once
+        if (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL)
+        {
+            stats.poolOverflows++;
+            current = acquirePool();
+            allocInfo.descriptorPool = current;
+            result = vkAllocateDescriptorSets(*device, &allocInfo, &set);
+        }
+
+        if (result != VK_SUCCESS)
+        {
+            std::cout << "Error, descriptor set allocation failed: " << result << std::endl;
+            return VK_NULL_HANDLE;
+        }
+
+        stats.allocations++;
+        return set;
+    }
+
+    void DescriptorAllocator::nextFrame(SubmitToken frameToken)
+    {
+        std::lock_guard lock(mutex);
+
+        if (current != VK_NULL_HANDLE)
+        {
+            used.push_back(current);
+            current = VK_NULL_HANDLE;
+        }
+
+        // Everything allocated since the last call was used by the frame just submitted at the latest
+        if (!used.empty())
+        {
+            retired.push_back({ std::move(used), frameToken });
+            used.clear();
+        }
+
+        while (!retired.empty() && retired.front().token.timeline->isComplete(retired.front().token.value))
+        {
+            for (auto pool : retired.front().pools)
+            {
+                vkResetDescriptorPool(*device, pool, 0);
+                freePools.push_back(pool);
+                stats.poolResets++;
+            }
+
+            retired.pop_front();
+        }
+    }
+
+    DescriptorAllocator::Stats DescriptorAllocator::getStats()
+    {
+        std::lock_guard lock(mutex);
+        return stats;
+    }
+
+    VkDescriptorPool DescriptorAllocator::acquirePool()
+    {
+        if (current != VK_NULL_HANDLE)
+            used.push_back(current);
+
+        if (!freePools.empty())
+        {
+            const auto pool = freePools.back();
+            freePools.pop_back();
+            return pool;
+        }
+
+        return createPool();
+    }
+
+    VkDescriptorPool DescriptorAllocator::createPool()
+    {
+        const uint32_t maxSets = stats.setsPerPool;
+        auto poolSizes = std::vector<VkDescriptorPoolSize>();
+
+        if (observedSets > 0)
+        {
+            // Scale the observed per-set average of each type up to the pool's set count
+            for (uint32_t type = 0; type < DESCRIPTOR_TYPE_COUNT; type++)
+            {
+                if (observedCounts[type] == 0)
+                    continue;
+
+                const auto perSet = double(observedCounts[type]) / double(observedSets);
+                const auto count = uint32_t(perSet * maxSets) + 1;
+                poolSizes.push_back(Inits::descriptorPoolSize(VkDescriptorType(type), count));
+            }
+        }
+        else
+        {
+            poolSizes.push_back(Inits::descriptorPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, maxSets));
+            poolSizes.push_back(Inits::descriptorPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, maxSets * 2));
+            poolSizes.push_back(Inits::descriptorPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, maxSets / 2));
+        }
+
+        const auto poolInfo = Inits::descriptorPoolCreateInfo(poolSizes.data(), poolSizes.size(), maxSets);
+
+        VkDescriptorPool pool = VK_NULL_HANDLE;
+        vkCreateDescriptorPool(*device, &poolInfo, nullptr, &pool);
+        allPools.push_back(pool);
+
+        stats.pools++;
+        stats.setsPerPool = min(maxSets * 2, MaxSetsPerPool);
+        return pool;
+    }
+} // vks
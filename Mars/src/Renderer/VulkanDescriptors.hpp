@@ -0,0 +1,115 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#pragma once
+
+#include "VulkanDevice.hpp"
+#include "../Utilities/hash_utils.hpp"
+
+namespace vks
+{
+    // Core descriptor types only, extension types are not pooled by the allocator
+    constexpr uint32_t DESCRIPTOR_TYPE_COUNT = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT + 1;
+    // Deduplicates descriptor set layouts by their sorted bindings, layouts live until shutdown
+    // Deduplicates descriptor set layouts by a hash of their bindings, layouts live until shutdown
+    class DescriptorLayoutCache
+    {
+    public:
+        struct LayoutInfo
+        {
+            uint32_t    descriptorCounts[DESCRIPTOR_TYPE_COUNT];
+        };
+
+        void initialise(VkDevice dev);
+        void shutdown();
+
+        VkDescriptorSetLayout getLayout(const VkDescriptorSetLayoutBinding *pBindings, uint32_t bindingCount);
+
+        template<uint32_t N>
+        VkDescriptorSetLayout getLayout(const VkDescriptorSetLayoutBinding(&bindings)[N])
+        {
+            return getLayout(bindings, N);
+        }
+
+        // Per-type descriptor counts, lets the allocator size pools from real usage
+        LayoutInfo getInfo(VkDescriptorSetLayout layout);
+
+        uint32_t layoutCount();
+
+    private:
+        struct CachedLayout
+        {
+            VkDescriptorSetLayout                       layout;
+            std::vector<VkDescriptorSetLayoutBinding>   bindings;   // Sorted, pImmutableSamplers is only tested for null
+            std::vector<VkSampler>                      samplers;   // Copied, the caller's arrays may not outlive the call
+        };
+
+        // Compares field by field, a hash match alone may be a collision
+        static bool sameBindings(const CachedLayout &cached,
+                                 const std::vector<VkDescriptorSetLayoutBinding> &bindings,
+                                 const std::vector<VkSampler> &samplers);
+
+        VkDevice                                                    device;
+        std::unordered_multimap<uint64_t, CachedLayout>             layouts;    // By hash of the sorted bindings
+        std::unordered_map<VkDescriptorSetLayout, LayoutInfo>       infos;
+        std::mutex                                                  mutex;
+    };
+
+    // Allocates descriptor sets from a chain of pools. An exhausted pool is replaced by a new one sized
+    // from the descriptor mix observed so far, growing with each overflow. For per-frame sets call
+    // nextFrame() right after each frame's submission: pools used since the previous call are reset
+    // wholesale once that frame completes, instead of freeing sets one by one. Layouts have to come
+    // from the layout cache the allocator was initialised with.
+    class DescriptorAllocator
+    {
+        static constexpr uint32_t InitialSetsPerPool = 64;
+        static constexpr uint32_t MaxSetsPerPool = 4096;
+
+        struct RetiredPools
+        {
+            std::vector<VkDescriptorPool>   pools;
+            SubmitToken                     token;
+        };
+
+    public:
+        struct Stats
+        {
+            uint32_t    pools;              // Created in total
+            uint32_t    poolOverflows;      // Allocations that had to move on to another pool
+            uint32_t    poolResets;
+            uint32_t    allocations;
+            uint32_t    setsPerPool;        // Size the next new pool will get
+        };
+
+        void initialise(VulkanDevice *dev, DescriptorLayoutCache *layoutCache);
+        void shutdown();
+
+        VkDescriptorSet allocate(VkDescriptorSetLayout layout);
+
+        // Retires the pools used since the last call against the frame just submitted, whose real
+        // timeline value frameToken holds, and recycles the ones the GPU has finished with
+        void nextFrame(SubmitToken frameToken);
+
+        Stats getStats();
+
+    private:
+        VkDescriptorPool acquirePool();
+        VkDescriptorPool createPool();
+
+        VulkanDevice                    *device;
+        DescriptorLayoutCache           *layouts;
+        VkDescriptorPool                current;
+        std::vector<VkDescriptorPool>   used;
+        std::vector<VkDescriptorPool>   freePools;
+        std::deque<RetiredPools>        retired;
+        std::vector<VkDescriptorPool>   allPools;
+
+        // Descriptors and sets allocated since initialise, the mix new pools are sized by
+        uint64_t                        observedCounts[DESCRIPTOR_TYPE_COUNT];
+        uint64_t                        observedSets;
+
+        std::mutex                      mutex;
+        Stats                           stats;
+    };
+} // vks
@@ -3,60 +3,189 @@
 //
 
 #include "VulkanDevice.hpp"
+#include "VulkanBindless.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 
 namespace vks
 {
-    void VulkanDevice::initialise(VkInstance instance, VkSurfaceKHR surface)
+    void VulkanDevice::initialise(VkInstance instance, VkSurfaceKHR surface, const char *cachePath, std::string_view gpuOverride)
     {
-        uint32_t deviceCount = 0;
-        vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
-        auto physicalDevices = std::vector<VkPhysicalDevice>(deviceCount);
-        vkEnumeratePhysicalDevices(instance, &deviceCount, physicalDevices.data());
+        selectPhysicalDevice(instance, surface, gpuOverride);
+
+        vkGetPhysicalDeviceProperties(gpu, &gpuProperties);
+        vkGetPhysicalDeviceMemoryProperties(gpu, &memProps);
+
+        uint32_t extensionCount = 0;
+        vkEnumerateDeviceExtensionProperties(gpu, nullptr, &extensionCount, nullptr);
+        availableExtensions.resize(extensionCount);
+        vkEnumerateDeviceExtensionProperties(gpu, nullptr, &extensionCount, availableExtensions.data());
+
+        enabledExtensions.assign(std::begin(DeviceExtensions), std::end(DeviceExtensions));
+
+        // Only resolves when the instance enabled VK_KHR_get_physical_device_properties2
+        auto getMemoryProperties2 = reinterpret_cast<PFN_vkGetPhysicalDeviceMemoryProperties2KHR>(
+                vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceMemoryProperties2KHR"));
+
+        extensions.memoryBudget = getMemoryProperties2 && extensionSupported(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+        if (extensions.memoryBudget)
+            enabledExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+        memoryBudget.initialise(gpu, memProps, extensions.memoryBudget ? getMemoryProperties2 : nullptr);
+
+        extensions.creationFeedback = extensionSupported(VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME);
+
+        if (extensions.creationFeedback)
+            enabledExtensions.push_back(VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME);
+
+        extensions.drawIndirectCount = extensionSupported(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+
+        if (extensions.drawIndirectCount)
+            enabledExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
 
-        gpu = physicalDevices[0];
+        auto getFeatures2 = reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2KHR>(
+                vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceFeatures2KHR"));
 
-        for (auto candidate : physicalDevices)
+        // Optional feature structs are queried through one features2 chain
+        VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineFeatures{};
+        timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+
+        VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures{};
+        indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+
+        void *featureChain = nullptr;
+        extensions.timelineSemaphore = getFeatures2 && extensionSupported(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+        extensions.descriptorIndexing = getFeatures2 &&
+                                        extensionSupported(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME) &&
+                                        extensionSupported(VK_KHR_MAINTENANCE3_EXTENSION_NAME);
+
+        if (extensions.timelineSemaphore)
         {
-            const auto extensionsSupported = checkDeviceExtensions(candidate);
-            const auto adequateCapabilities = checkSurfaceFormatSupport(candidate, surface);
-            const auto adequateIndices = checkQueueIndices(candidate, surface);
+            timelineFeatures.pNext = featureChain;
+            featureChain = &timelineFeatures;
+        }
 
-            if (extensionsSupported && adequateCapabilities && adequateIndices)
-            {
-                gpu = candidate;
-                break;
-            }
+        if (extensions.descriptorIndexing)
+        {
+            indexingFeatures.pNext = featureChain;
+            featureChain = &indexingFeatures;
         }
 
-        vkGetPhysicalDeviceProperties(gpu, &gpuProperties);
-        vkGetPhysicalDeviceMemoryProperties(gpu, &memProps);
+        if (featureChain != nullptr)
+        {
+            VkPhysicalDeviceFeatures2KHR features2{};
+            features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+            features2.pNext = featureChain;
+            getFeatures2(gpu, &features2);
+        }
+
+        extensions.timelineSemaphore = extensions.timelineSemaphore && timelineFeatures.timelineSemaphore;
 
-        const uint32_t queueFamilies[] = { indices.graphics, indices.present };
-        const uint32_t queueCount = (indices.graphics != indices.present) ? 2 : 1;
+        // The subset bindless descriptors rely on
+        extensions.descriptorIndexing = extensions.descriptorIndexing &&
+                                        indexingFeatures.runtimeDescriptorArray &&
+                                        indexingFeatures.descriptorBindingPartiallyBound &&
+                                        indexingFeatures.descriptorBindingUpdateUnusedWhilePending &&
+                                        indexingFeatures.descriptorBindingSampledImageUpdateAfterBind &&
+                                        indexingFeatures.descriptorBindingStorageBufferUpdateAfterBind &&
+                                        indexingFeatures.shaderSampledImageArrayNonUniformIndexing;
 
-        VkDeviceQueueCreateInfo queueCreateInfos[2] = {};
+        // Rebuilt so only the features of extensions we actually enable reach vkCreateDevice
+        featureChain = nullptr;
 
+        if (extensions.timelineSemaphore)
+        {
+            enabledExtensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+            timelineFeatures.pNext = featureChain;
+            featureChain = &timelineFeatures;
+        }
+
+        if (extensions.descriptorIndexing)
+        {
+            enabledExtensions.push_back(VK_KHR_MAINTENANCE3_EXTENSION_NAME);
+            enabledExtensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+
+            indexingFeatures = {};
+            indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+            indexingFeatures.runtimeDescriptorArray = VK_TRUE;
+            indexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+            indexingFeatures.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+            indexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+            indexingFeatures.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+            indexingFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+            indexingFeatures.pNext = featureChain;
+            featureChain = &indexingFeatures;
+
+            auto getProperties2 = reinterpret_cast<PFN_vkGetPhysicalDeviceProperties2KHR>(
+                    vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceProperties2KHR"));
+
+            descriptorIndexingProps = {};
+            descriptorIndexingProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+
+            VkPhysicalDeviceProperties2KHR properties2{};
+            properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR;
+            properties2.pNext = &descriptorIndexingProps;
+            getProperties2(gpu, &properties2);
+        }
+
+        // Without timeline semaphores the graphics queue could only wait on compute from the CPU
+        if (!extensions.timelineSemaphore)
+            indices.compute = indices.graphics;
+
+        uint32_t queueFamilies[3] = { indices.graphics };
+        uint32_t queueCount = 1;
+
+        for (const auto family : { indices.present, indices.compute })
+        {
+            if (std::find(queueFamilies, queueFamilies + queueCount, family) == queueFamilies + queueCount)
+                queueFamilies[queueCount++] = family;
+        }
+
+        VkDeviceQueueCreateInfo queueCreateInfos[3] = {};
+
+        // One queue per distinct family
         float queuePriority = 1.0f;
         for (size_t i = 0; i < queueCount; i++)
         {
             queueCreateInfos[i].sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
             queueCreateInfos[i].queueFamilyIndex = queueFamilies[i];
-            queueCreateInfos[i].queueCount = queueCount;
+            queueCreateInfos[i].queueCount = 1;
             queueCreateInfos[i].pQueuePriorities = &queuePriority;
             queueCreateInfos[i].flags = 0;
             queueCreateInfos[i].pNext = nullptr;
         }
 
+        VkPhysicalDeviceFeatures supportedFeatures{};
+        vkGetPhysicalDeviceFeatures(gpu, &supportedFeatures);
+
         VkPhysicalDeviceFeatures deviceFeatures{};
         deviceFeatures.sampleRateShading = VK_TRUE;
 
+        // Optional, only used by the query instrumentation
+        deviceFeatures.pipelineStatisticsQuery = supportedFeatures.pipelineStatisticsQuery;
+        deviceFeatures.occlusionQueryPrecise = supportedFeatures.occlusionQueryPrecise;
+
+        // GPU driven draws, the instance index carries the object index
+        deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+        deviceFeatures.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+        enabledFeatures = deviceFeatures;
+
         VkDeviceCreateInfo createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+        createInfo.pNext = featureChain;
         createInfo.queueCreateInfoCount = queueCount;
         createInfo.pQueueCreateInfos = queueCreateInfos;
         createInfo.pEnabledFeatures = &deviceFeatures;
-        createInfo.enabledExtensionCount = arraysize32(DeviceExtensions);
-        createInfo.ppEnabledExtensionNames = DeviceExtensions;
+        createInfo.enabledExtensionCount = uint32_t(enabledExtensions.size());
+        createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 #ifdef ENABLE_VALIDATION
         createInfo.enabledLayerCount = arraysize32(ValidationLayers);
         createInfo.ppEnabledLayerNames = ValidationLayers;
@@ -66,109 +195,641 @@ namespace vks
 #endif
         vkCreateDevice(gpu, &createInfo, nullptr, &device);
 
+        cmdDrawIndexedIndirectCount = extensions.drawIndirectCount ?
+                reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(vkGetDeviceProcAddr(device, "vkCmdDrawIndexedIndirectCountKHR")) :
+                nullptr;
+
         auto poolInfo = Inits::commandPoolCreateInfo(indices.graphics);
         poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
         vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool);
 
+        fences.initialise(device);
+        transientPools.initialise(device, indices.graphics);
+
         vkGetDeviceQueue(device, indices.graphics, 0, &graphicsQueue);
         vkGetDeviceQueue(device, indices.present, 0, &presentQueue);
+        vkGetDeviceQueue(device, indices.compute, 0, &computeQueue);
 
-        VkPipelineCacheCreateInfo pipelineCacheInfo{};
-        pipelineCacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
-        pipelineCacheInfo.pInitialData = VK_NULL_HANDLE;
-        pipelineCacheInfo.initialDataSize = 0;
-        vkCreatePipelineCache(device, &pipelineCacheInfo, nullptr, &pipelineCache);
+        TimelineFunctions timelineFunctions{};
+
+        if (extensions.timelineSemaphore)
+        {
+            timelineFunctions.waitSemaphores = reinterpret_cast<PFN_vkWaitSemaphoresKHR>(
+                    vkGetDeviceProcAddr(device, "vkWaitSemaphoresKHR"));
+            timelineFunctions.getCounterValue = reinterpret_cast<PFN_vkGetSemaphoreCounterValueKHR>(
+                    vkGetDeviceProcAddr(device, "vkGetSemaphoreCounterValueKHR"));
+        }
+
+        graphicsTimeline.initialise(device, graphicsQueue, &fences, timelineFunctions);
+        presentTimeline.initialise(device, presentQueue, &fences, timelineFunctions);
+        computeTimeline.initialise(device, computeQueue, &fences, timelineFunctions);
+        deletionQueue.initialise(this);
+
+        pipelineCachePath = cachePath;
+        pipelineCacheSaveInterval = 0;
+        pipelinesSinceSave = 0;
+        pipelineCacheStats = {};
+        loadPipelineCache();
+
+        bindless = nullptr;
+
+        if (extensions.descriptorIndexing)
+        {
+            bindless = new BindlessDescriptors();
+
+            if (!bindless->initialise(this))
+            {
+                delete bindless;
+                bindless = nullptr;
+            }
+        }
     }
 
     void VulkanDevice::shutdown()
     {
+        if (bindless != nullptr)
+        {
+            bindless->shutdown();
+            delete bindless;
+            bindless = nullptr;
+        }
+
+        graphicsTimeline.shutdown();
+        presentTimeline.shutdown();
+        computeTimeline.shutdown();
+        collectSubmissions();
+        deletionQueue.shutdown();
+
+        transientPools.shutdown();
+        fences.shutdown();
+
+        savePipelineCache();
         vkDestroyPipelineCache(device, pipelineCache, nullptr);
         vkDestroyCommandPool(device, commandPool, nullptr);
         vkDestroyDevice(device, nullptr);
     }
 
-    VkMemoryAllocateInfo
-    VulkanDevice::getMemoryAllocInfo(VkMemoryRequirements memReqs, VkMemoryPropertyFlags flags) const
+    VkResult VulkanDevice::createGraphicsPipeline(const VkGraphicsPipelineCreateInfo &createInfo, VkPipeline *pPipeline)
+    {
+        VkPipelineCreationFeedbackEXT feedback{};
+        VkPipelineCreationFeedbackCreateInfoEXT feedbackInfo{};
+        feedbackInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO_EXT;
+        feedbackInfo.pPipelineCreationFeedback = &feedback;
+
+        auto info = createInfo;
+
+        if (extensions.creationFeedback)
+        {
+            feedbackInfo.pNext = info.pNext;
+            info.pNext = &feedbackInfo;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto result = vkCreateGraphicsPipelines(device, pipelineCache, 1, &info, nullptr, pPipeline);
+        const auto compileMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+        if (result == VK_SUCCESS)
+            recordPipeline(feedback, compileMs.count());
+
+        return result;
+    }
+
+    VkResult VulkanDevice::createComputePipeline(const VkComputePipelineCreateInfo &createInfo, VkPipeline *pPipeline)
+    {
+        VkPipelineCreationFeedbackEXT feedback{};
+        VkPipelineCreationFeedbackCreateInfoEXT feedbackInfo{};
+        feedbackInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO_EXT;
+        feedbackInfo.pPipelineCreationFeedback = &feedback;
+
+        auto info = createInfo;
+
+        if (extensions.creationFeedback)
+        {
+            feedbackInfo.pNext = info.pNext;
+            info.pNext = &feedbackInfo;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto result = vkCreateComputePipelines(device, pipelineCache, 1, &info, nullptr, pPipeline);
+        const auto compileMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+        if (result == VK_SUCCESS)
+            recordPipeline(feedback, compileMs.count());
+
+        return result;
+    }
+
+    void VulkanDevice::savePipelineCache()
+    {
+        std::lock_guard lock(pipelineCacheMutex);
+
+        size_t dataSize = 0;
+        vkGetPipelineCacheData(device, pipelineCache, &dataSize, nullptr);
+        auto data = std::vector<char>(dataSize);
+        vkGetPipelineCacheData(device, pipelineCache, &dataSize, data.data());
+
+        // Write next to the old file and swap it in, a crash mid-write never leaves a torn cache behind
+        const auto tempPath = pipelineCachePath + ".tmp";
+        {
+            auto file = std::ofstream(tempPath, std::ios::binary | std::ios::trunc);
+            file.write(data.data(), std::streamsize(dataSize));
+
+            if (!file)
+            {
+                std::cout << "Warning, could not write pipeline cache " << tempPath << std::endl;
+                return;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(tempPath, pipelineCachePath, error);
+
+        if (error)
+        {
+            std::cout << "Warning, could not replace pipeline cache: " << error.message() << std::endl;
+            std::filesystem::remove(tempPath, error);
+            return;
+        }
+
+        pipelineCacheStats.savedBytes = dataSize;
+        pipelinesSinceSave = 0;
+    }
+
+    PipelineCacheStats VulkanDevice::getPipelineCacheStats()
+    {
+        std::lock_guard lock(pipelineCacheMutex);
+        return pipelineCacheStats;
+    }
+
+    void VulkanDevice::loadPipelineCache()
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        auto data = std::vector<char>();
+        {
+            auto file = std::ifstream(pipelineCachePath, std::ios::binary | std::ios::ate);
+
+            if (file)
+            {
+                data.resize(size_t(file.tellg()));
+                file.seekg(0);
+                file.read(data.data(), std::streamsize(data.size()));
+
+                if (!file)
+                    data.clear();
+            }
+        }
+
+        // The driver would reject a foreign cache too, but validating the header ourselves lets us
+        // tell a cold start from a stale or corrupt file and never hands garbage to the driver
+        if (!data.empty())
+        {
+            VkPipelineCacheHeaderVersionOne header{};
+            bool valid = data.size() >= sizeof(header);
+
+            if (valid)
+            {
+                std::memcpy(&header, data.data(), sizeof(header));
+                valid = header.headerSize >= sizeof(header) &&
+                        header.headerSize <= data.size() &&
+                        header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+                        header.vendorID == gpuProperties.vendorID &&
+                        header.deviceID == gpuProperties.deviceID &&
+                        std::memcmp(header.pipelineCacheUUID, gpuProperties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+            }
+
+            if (!valid)
+            {
+                std::cout << "Discarding stale or corrupt pipeline cache " << pipelineCachePath << std::endl;
+                data.clear();
+            }
+        }
+
+        VkPipelineCacheCreateInfo pipelineCacheInfo{};
+        pipelineCacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        pipelineCacheInfo.pInitialData = data.empty() ? nullptr : data.data();
+        pipelineCacheInfo.initialDataSize = data.size();
+
+        if (vkCreatePipelineCache(device, &pipelineCacheInfo, nullptr, &pipelineCache) != VK_SUCCESS)
+        {
+            pipelineCacheInfo.pInitialData = nullptr;
+            pipelineCacheInfo.initialDataSize = 0;
+            data.clear();
+            vkCreatePipelineCache(device, &pipelineCacheInfo, nullptr, &pipelineCache);
+        }
+
+        pipelineCacheStats.loadedBytes = data.size();
+        pipelineCacheStats.loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "Pipeline cache " << (data.empty() ? "cold" : "warm") << ", loaded "
+                  << data.size() << " bytes in " << pipelineCacheStats.loadMs << " ms" << std::endl;
+    }
+
+    void VulkanDevice::recordPipeline(const VkPipelineCreationFeedbackEXT &feedback, double compileMs)
+    {
+        bool save = false;
+        {
+            std::lock_guard lock(pipelineCacheMutex);
+
+            pipelineCacheStats.pipelinesCreated++;
+            pipelineCacheStats.compileMs += compileMs;
+
+            if (feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT_EXT)
+            {
+                if (feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT_EXT)
+                    pipelineCacheStats.hits++;
+                else
+                    pipelineCacheStats.misses++;
+            }
+
+            pipelinesSinceSave++;
+            save = pipelineCacheSaveInterval > 0 && pipelinesSinceSave >= pipelineCacheSaveInterval;
+        }
+
+        if (save)
+            savePipelineCache();
+    }
+
+    uint32_t VulkanDevice::findMemoryType(uint32_t typeBits,
+                                          VkMemoryPropertyFlags required,
+                                          VkMemoryPropertyFlags preferred,
+                                          VkDeviceSize size) const
+    {
+        // Properties that change behaviour and should never be picked up by accident
+        constexpr VkMemoryPropertyFlags ExclusiveFlags = VK_MEMORY_PROPERTY_PROTECTED_BIT |
+                                                         VK_MEMORY_PROPERTY_DEVICE_COHERENT_BIT_AMD |
+                                                         VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+
+        uint32_t bestType = INVALID_MEMORY_TYPE;
+        int32_t bestScore = INT32_MIN;
+
+        for (uint32_t i = 0; i < memProps.memoryTypeCount; i++)
+        {
+            const auto typeFlags = memProps.memoryTypes[i].propertyFlags;
+
+            if (!(typeBits & BIT(i)) || (typeFlags & required) != required)
+                continue;
+
+            const auto wanted = required | preferred;
+            if (typeFlags & ExclusiveFlags & ~wanted)
+                continue;
+
+            int32_t score = 0;
+            score += 16 * std::popcount(typeFlags & preferred);
+            score -= 4 * std::popcount(typeFlags & ~wanted);
+
+            if (size > 0 && !memoryBudget.fits(i, size))
+                score -= 256;
+
+            // Ties keep the lower index, drivers list their best types first
+            if (score > bestScore)
+            {
+                bestScore = score;
+                bestType = i;
+            }
+        }
+
+        return bestType;
+    }
+
+    VkMemoryAllocateInfo VulkanDevice::getMemoryAllocInfo(VkMemoryRequirements memReqs,
+                                                          VkMemoryPropertyFlags required,
+                                                          VkMemoryPropertyFlags preferred) const
     {
         VkMemoryAllocateInfo allocInfo{};
         allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
         allocInfo.allocationSize = memReqs.size;
-        allocInfo.memoryTypeIndex = 0;
+        allocInfo.memoryTypeIndex = findMemoryType(memReqs.memoryTypeBits, required, preferred, memReqs.size);
 
-        for (uint32_t i = 0; i < memProps.memoryTypeCount; i++)
+        if (allocInfo.memoryTypeIndex == INVALID_MEMORY_TYPE)
         {
-            if ((memReqs.memoryTypeBits & BIT(i)) && (memProps.memoryTypes[i].propertyFlags & flags))
+            std::cout << "Warning, no memory type has the required properties " << required << std::endl;
+            allocInfo.memoryTypeIndex = std::countr_zero(memReqs.memoryTypeBits);
+        }
+
+        return allocInfo;
+    }
+
+    VkResult VulkanDevice::allocateMemory(const VkMemoryAllocateInfo &allocInfo, VkDeviceMemory *pMemory)
+    {
+        const auto result = vkAllocateMemory(device, &allocInfo, nullptr, pMemory);
+
+        if (result == VK_SUCCESS)
+        {
+            memoryBudget.onAllocate(allocInfo.memoryTypeIndex, allocInfo.allocationSize);
+
+            std::lock_guard lock(memoryMutex);
+            memoryBlocks[*pMemory] = {allocInfo.allocationSize, allocInfo.memoryTypeIndex};
+        }
+
+        return result;
+    }
+
+    void VulkanDevice::freeMemory(VkDeviceMemory memory)
+    {
+        if (memory == VK_NULL_HANDLE)
+            return;
+
+        {
+            std::lock_guard lock(memoryMutex);
+
+            const auto it = memoryBlocks.find(memory);
+            if (it != memoryBlocks.end())
             {
-                allocInfo.memoryTypeIndex = i;
-                break;
+                memoryBudget.onFree(it->second.typeIndex, it->second.size);
+                memoryBlocks.erase(it);
             }
         }
 
-        return allocInfo;
+        vkFreeMemory(device, memory, nullptr);
     }
 
-    VkCommandBuffer VulkanDevice::createCommandBuffer(VkCommandBufferLevel level, bool begin) const
+    bool VulkanDevice::canAllocate(VkMemoryRequirements memReqs,
+                                   VkMemoryPropertyFlags required,
+                                   VkMemoryPropertyFlags preferred) const
     {
-        VkCommandBuffer command = VK_NULL_HANDLE;
+        const auto typeIndex = findMemoryType(memReqs.memoryTypeBits, required, preferred);
 
-        auto allocateInfo = Inits::commandBufferAllocateInfo(commandPool, 1);
-        allocateInfo.level = level;
-        vkAllocateCommandBuffers(device, &allocateInfo, &command);
+        if (typeIndex == INVALID_MEMORY_TYPE)
+            return false;
+
+        return memoryBudget.fits(typeIndex, memReqs.size);
+    }
+
+    bool VulkanDevice::extensionSupported(const char *name) const
+    {
+        for (const auto &extension : availableExtensions)
+        {
+            if (std::strcmp(extension.extensionName, name) == 0)
+                return true;
+        }
+
+        return false;
+    }
+
+    VkCommandBuffer VulkanDevice::createCommandBuffer(VkCommandBufferLevel level, bool begin)
+    {
+        const auto command = transientPools.allocate(level);
 
         if (begin)
         {
-            const auto beginInfo = Inits::commandBufferBeginInfo(0);
+            const auto beginInfo = Inits::commandBufferBeginInfo(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
             vkBeginCommandBuffer(command, &beginInfo);
         }
 
         return command;
     }
 
-    void VulkanDevice::flushCommandBuffer(VkCommandBuffer command, VkQueue queue, bool free) const
+    void VulkanDevice::freeCommandBuffer(VkCommandBuffer command)
+    {
+        transientPools.release(command);
+    }
+
+    void VulkanDevice::flushCommandBuffer(VkCommandBuffer command, VkQueue queue, bool free)
+    {
+        wait(submitOneShot(command, queue, free));
+    }
+
+    SubmitToken VulkanDevice::submitOneShot(VkCommandBuffer command, VkQueue queue, bool free)
     {
         vkEndCommandBuffer(command);
 
-        auto fenceInfo = Inits::fenceCreateInfo(0);
-        VkFence fence = VK_NULL_HANDLE;
-        vkCreateFence(device, &fenceInfo, nullptr, &fence);
+        TimelineSubmitInfo submitInfo{};
+        submitInfo.pCommandBuffers = &command;
+        submitInfo.commandBufferCount = 1;
+
+        auto &timeline = getTimeline(queue);
+        const auto token = SubmitToken{&timeline, timeline.submit(submitInfo)};
+
+        std::lock_guard lock(submitMutex);
+        pending.push_back({token, command, free});
+        return token;
+    }
+
+    bool VulkanDevice::isComplete(SubmitToken token)
+    {
+        if (!token.timeline->isComplete(token.value))
+            return false;
+
+        std::lock_guard lock(submitMutex);
+        collectSubmissions();
+        return true;
+    }
+
+    void VulkanDevice::wait(SubmitToken token)
+    {
+        token.timeline->wait(token.value);
+
+        std::lock_guard lock(submitMutex);
+        collectSubmissions();
+    }
+
+    void VulkanDevice::collectSubmissions()
+    {
+        for (auto it = pending.begin(); it != pending.end();)
+        {
+            if (!it->token.timeline->isComplete(it->token.value))
+            {
+                ++it;
+                continue;
+            }
 
-        auto submitInfo = Inits::submitInfo(&command, 1);
-        vkQueueSubmit(queue, 1, &submitInfo, fence);
-        vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
-        vkDestroyFence(device, fence, nullptr);
+            if (it->free)
+                transientPools.release(it->command);
 
-        if (free)
-            vkFreeCommandBuffers(device, commandPool, 1, &command);
+            it = pending.erase(it);
+        }
     }
 
-    bool VulkanDevice::checkDeviceExtensions(VkPhysicalDevice pd)
+    void VulkanDevice::selectPhysicalDevice(VkInstance instance, VkSurfaceKHR surface, std::string_view gpuOverride)
+    {
+        uint32_t deviceCount = 0;
+        vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
+        auto physicalDevices = std::vector<VkPhysicalDevice>(deviceCount);
+        vkEnumeratePhysicalDevices(instance, &deviceCount, physicalDevices.data());
+
+        // The environment wins, so a deployment can be redirected without a rebuild
+        if (const auto env = std::getenv(GpuOverrideVariable); env != nullptr && *env != '\0')
+            gpuOverride = env;
+
+        // All digits selects by enumeration index, anything else by a case insensitive part of the name
+        const bool overrideByIndex = !gpuOverride.empty() &&
+                                     std::all_of(gpuOverride.begin(), gpuOverride.end(), [](char c){ return std::isdigit(uint8_t(c)); });
+
+        const auto toLower = [](std::string_view text){
+            auto lower = std::string(text);
+            std::transform(lower.begin(), lower.end(), lower.begin(), [](char c){ return char(std::tolower(uint8_t(c))); });
+            return lower;
+        };
+
+        const auto overrideName = toLower(gpuOverride);
+
+        gpu = VK_NULL_HANDLE;
+        VkPhysicalDevice overrideGpu = VK_NULL_HANDLE;
+        uint64_t bestScore = 0;
+
+        for (uint32_t i = 0; i < deviceCount; i++)
+        {
+            const auto candidate = physicalDevices[i];
+
+            VkPhysicalDeviceProperties properties;
+            vkGetPhysicalDeviceProperties(candidate, &properties);
+
+            std::string reason;
+            const bool suitable = checkDeviceExtensions(candidate, reason) &&
+                                  checkSurfaceFormatSupport(candidate, surface, reason) &&
+                                  checkQueueIndices(candidate, surface, reason);
+
+            std::cout << "GPU " << i << " " << properties.deviceName;
+
+            if (!suitable)
+            {
+                std::cout << ": rejected, " << reason << std::endl;
+                continue;
+            }
+
+            const auto score = scoreDevice(candidate, reason);
+            std::cout << ": accepted, score " << score << " (" << reason << ")" << std::endl;
+
+            const bool overridden = overrideByIndex ? std::to_string(i) == gpuOverride :
+                                    !overrideName.empty() && toLower(properties.deviceName).find(overrideName) != std::string::npos;
+
+            if (overridden && overrideGpu == VK_NULL_HANDLE)
+                overrideGpu = candidate;
+
+            if (gpu == VK_NULL_HANDLE || score > bestScore)
+            {
+                gpu = candidate;
+                bestScore = score;
+            }
+        }
+
+        if (!gpuOverride.empty())
+        {
+            if (overrideGpu != VK_NULL_HANDLE)
+                gpu = overrideGpu;
+            else
+                std::cout << "Warning, no suitable GPU matches override \"" << gpuOverride << "\", using the highest score" << std::endl;
+        }
+
+        if (gpu == VK_NULL_HANDLE)
+        {
+            std::cout << "Error, no GPU meets the requirements, falling back to the first one" << std::endl;
+            gpu = physicalDevices[0];
+        }
+
+        // Queue indices are filled in per candidate, so they have to come from the chosen one
+        std::string reason;
+        checkQueueIndices(gpu, surface, reason);
+    }
+
+    uint64_t VulkanDevice::scoreDevice(VkPhysicalDevice pd, std::string &reason)
+    {
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(pd, &properties);
+
+        VkPhysicalDeviceMemoryProperties memory;
+        vkGetPhysicalDeviceMemoryProperties(pd, &memory);
+
+        VkPhysicalDeviceFeatures features;
+        vkGetPhysicalDeviceFeatures(pd, &features);
+
+        uint32_t familyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(pd, &familyCount, nullptr);
+        auto families = std::vector<VkQueueFamilyProperties>(familyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(pd, &familyCount, families.data());
+
+        // Device type dominates, the rest only orders devices of the same kind
+        uint64_t typeScore = 0;
+
+        switch (properties.deviceType)
+        {
+            case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU: typeScore = 100000; break;
+            case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: typeScore = 10000; break;
+            case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU: typeScore = 1000; break;
+            case VK_PHYSICAL_DEVICE_TYPE_CPU: typeScore = 100; break;
+            default: break;
+        }
+
+        // Integrated parts report system memory as device local, which type already accounts for
+        VkDeviceSize localBytes = 0;
+
+        for (uint32_t i = 0; i < memory.memoryHeapCount; i++)
+        {
+            if (memory.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+                localBytes = max(localBytes, memory.memoryHeaps[i].size);
+        }
+
+        const uint64_t heapScore = localBytes / (256ull << 20);
+
+        bool asyncCompute = false, asyncTransfer = false;
+
+        for (const auto &family : families)
+        {
+            const auto flags = family.queueFlags;
+            asyncCompute = asyncCompute || ((flags & VK_QUEUE_COMPUTE_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT));
+            asyncTransfer = asyncTransfer || ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)));
+        }
+
+        const uint64_t queueScore = (asyncCompute ? 200 : 0) + (asyncTransfer ? 100 : 0);
+
+        const uint64_t featureScore = (features.samplerAnisotropy ? 50 : 0) +
+                                      (features.pipelineStatisticsQuery ? 25 : 0) +
+                                      (features.occlusionQueryPrecise ? 25 : 0) +
+                                      (properties.limits.timestampComputeAndGraphics ? 50 : 0);
+
+        const auto samples = Tools::SampleCount(pd);
+        const uint64_t sampleScore = uint64_t(samples) * 10;
+
+        reason = "type " + std::to_string(typeScore) +
+                 ", " + std::to_string(localBytes >> 20) + " MiB local " + std::to_string(heapScore) +
+                 ", queues " + std::to_string(queueScore) +
+                 ", features " + std::to_string(featureScore) +
+                 ", " + std::to_string(samples) + "x MSAA " + std::to_string(sampleScore);
+
+        return typeScore + heapScore + queueScore + featureScore + sampleScore;
+    }
+
+    bool VulkanDevice::checkDeviceExtensions(VkPhysicalDevice pd, std::string &reason)
     {
         uint32_t extensionCount = 0;
         vkEnumerateDeviceExtensionProperties(pd, nullptr, &extensionCount, nullptr);
         auto extensions = std::vector<VkExtensionProperties>(extensionCount);
         vkEnumerateDeviceExtensionProperties(pd, nullptr, &extensionCount, extensions.data());
 
+        // Every required extension has to be present, not just one of them
         for (size_t i = 0; i < arraysize(DeviceExtensions); i++)
         {
-            for (auto& extension : extensions)
+            const auto found = std::any_of(extensions.begin(), extensions.end(), [&](const VkExtensionProperties &extension){
+                return std::strcmp(DeviceExtensions[i], extension.extensionName) == 0;
+            });
+
+            if (!found)
             {
-                if (std::strcmp(DeviceExtensions[i], extension.extensionName) == 0)
-                    return true;
+                reason = std::string("missing ") + DeviceExtensions[i];
+                return false;
             }
         }
 
-        return false;
+        return true;
     }
 
-    bool VulkanDevice::checkSurfaceFormatSupport(VkPhysicalDevice pd, VkSurfaceKHR surface)
+    bool VulkanDevice::checkSurfaceFormatSupport(VkPhysicalDevice pd, VkSurfaceKHR surface, std::string &reason)
     {
         uint32_t formatCount = 0, presentModeCount = 0;
         vkGetPhysicalDeviceSurfaceFormatsKHR(pd, surface, &formatCount, nullptr);
         vkGetPhysicalDeviceSurfacePresentModesKHR(pd, surface, &presentModeCount, nullptr);
-        return (formatCount > 0) && (presentModeCount > 0);
+
+        if (formatCount == 0 || presentModeCount == 0)
+        {
+            reason = "no surface formats or present modes for the window";
+            return false;
+        }
+
+        return true;
     }
 
-    bool VulkanDevice::checkQueueIndices(VkPhysicalDevice pd, VkSurfaceKHR surface)
+    bool VulkanDevice::checkQueueIndices(VkPhysicalDevice pd, VkSurfaceKHR surface, std::string &reason)
     {
         uint32_t propCount = 0;
         vkGetPhysicalDeviceQueueFamilyProperties(pd, &propCount, nullptr);
@@ -180,10 +841,14 @@ namespace vks
 
         for (uint32_t i = 0; i < properties.size(); i++)
         {
-            vkGetPhysicalDeviceSurfaceSupportKHR(gpu, i, surface, &present);
+            VkBool32 supported = VK_FALSE;
+            vkGetPhysicalDeviceSurfaceSupportKHR(pd, i, surface, &supported);
 
-            if (present)
+            if (supported)
+            {
                 indices.present = i;
+                present = VK_TRUE;
+            }
 
             if (properties[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)
             {
@@ -195,6 +860,23 @@ namespace vks
                 break;
         }
 
+        // A family without graphics runs compute alongside rasterisation, otherwise compute shares the graphics queue
+        indices.compute = indices.graphics;
+
+        for (uint32_t i = 0; i < properties.size(); i++)
+        {
+            if ((properties[i].queueFlags & VK_QUEUE_COMPUTE_BIT) && !(properties[i].queueFlags & VK_QUEUE_GRAPHICS_BIT))
+            {
+                indices.compute = i;
+                break;
+            }
+        }
+
+        if (!graphics)
+            reason = "no graphics queue family";
+        else if (!present)
+            reason = "no queue family can present to the window";
+
         return present && graphics;
     }
 } // vks
\ No newline at end of file
@@ -6,55 +6,195 @@
 
 #include "Base/VulkanInitialisers.hpp"
 #include "Base/VulkanTools.hpp"
+#include "VulkanCommandPools.hpp"
+#include "VulkanDeletionQueue.hpp"
+#include "VulkanMemory.hpp"
+#include "VulkanTimeline.hpp"
 
 namespace vks
 {
+    class BindlessDescriptors;
+
 #ifdef ENABLE_VALIDATION
     constexpr const char *ValidationLayers[] = { "VK_LAYER_KHRONOS_validation" };
 #endif
 
-    constexpr size_t MAX_IMAGES_IN_FLIGHT = 2;
+    // Upper bound for the frames-in-flight count chosen at startup
+    constexpr size_t MAX_IMAGES_IN_FLIGHT = 3;
+
+    struct PipelineCacheStats
+    {
+        size_t      loadedBytes;        // Zero on a cold start
+        size_t      savedBytes;
+        uint32_t    pipelinesCreated;
+        uint32_t    hits;               // Only counted with VK_EXT_pipeline_creation_feedback
+        uint32_t    misses;
+        double      loadMs;
+        double      compileMs;          // Total time spent in vkCreate*Pipelines
+    };
 
     class VulkanDevice
     {
         static constexpr const char *DeviceExtensions[] = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
 
+        // GPU index or part of its name, takes precedence over the override passed to initialise
+        static constexpr const char *GpuOverrideVariable = "MARS_GPU";
+
     public:
         constexpr operator VkDevice() const
         {
             return device;
         }
 
-        void initialise(VkInstance instance, VkSurfaceKHR surface);
+        // Picks the highest scoring GPU that can present to the surface, unless gpuOverride names
+        // a suitable one by enumeration index or part of its name
+        void initialise(VkInstance instance,
+                        VkSurfaceKHR surface,
+                        const char *cachePath = "pipeline.cache",
+                        std::string_view gpuOverride = {});
         void shutdown();
 
-        VkMemoryAllocateInfo getMemoryAllocInfo(VkMemoryRequirements memReqs, VkMemoryPropertyFlags flags) const;
-        VkCommandBuffer createCommandBuffer(VkCommandBufferLevel level, bool begin = true) const;
-        void flushCommandBuffer(VkCommandBuffer command, VkQueue queue, bool free = true) const;
+        // Pipelines created through these are counted and trigger the periodic cache save
+        VkResult createGraphicsPipeline(const VkGraphicsPipelineCreateInfo &createInfo, VkPipeline *pPipeline);
+        VkResult createComputePipeline(const VkComputePipelineCreateInfo &createInfo, VkPipeline *pPipeline);
+
+        // Atomically replaces the cache file, also done at shutdown
+        void savePipelineCache();
+
+        // Saves the cache every N new pipelines, zero only saves at shutdown
+        void setPipelineCacheSaveInterval(uint32_t count) { pipelineCacheSaveInterval = count; }
+
+        PipelineCacheStats getPipelineCacheStats();
+
+        // Picks the memory type that has every required flag and the most preferred flags,
+        // avoiding types with properties nobody asked for and heaps that are out of budget
+        uint32_t findMemoryType(uint32_t typeBits,
+                                VkMemoryPropertyFlags required,
+                                VkMemoryPropertyFlags preferred = 0,
+                                VkDeviceSize size = 0) const;
 
-        void flushCommandBuffer(VkCommandBuffer command, bool free = true) const
+        VkMemoryAllocateInfo getMemoryAllocInfo(VkMemoryRequirements memReqs,
+                                                VkMemoryPropertyFlags required,
+                                                VkMemoryPropertyFlags preferred = 0) const;
+
+        // Allocations made through these are counted against the heap budget
+        VkResult allocateMemory(const VkMemoryAllocateInfo &allocInfo, VkDeviceMemory *pMemory);
+        void freeMemory(VkDeviceMemory memory);
+
+        // Lets streaming systems evict before the driver starts paging
+        bool canAllocate(VkMemoryRequirements memReqs,
+                         VkMemoryPropertyFlags required,
+                         VkMemoryPropertyFlags preferred = 0) const;
+
+        bool extensionSupported(const char *name) const;
+
+        VkCommandBuffer createCommandBuffer(VkCommandBufferLevel level, bool begin = true);
+        void freeCommandBuffer(VkCommandBuffer command);
+
+        // A buffer kept with free = false, here or in submitOneShot, has to be given to freeCommandBuffer,
+        // until then its whole transient page can neither be reset nor reused
+        void flushCommandBuffer(VkCommandBuffer command, VkQueue queue, bool free = true);
+
+        void flushCommandBuffer(VkCommandBuffer command, bool free = true)
         {
             flushCommandBuffer(command, graphicsQueue, free);
         }
 
+        // Ends and submits a command buffer without blocking, the buffer is recycled once the token completes
+        SubmitToken submitOneShot(VkCommandBuffer command, VkQueue queue, bool free = true);
+        bool isComplete(SubmitToken token);
+        void wait(SubmitToken token);
+
+        CommandPools::Stats getCommandPoolStats() { return transientPools.getStats(); }
+        uint32_t getFenceCount() const { return fences.createdCount(); }
+
+        QueueTimeline &getTimeline(VkQueue queue)
+        {
+            if (queue == computeQueue && computeQueue != graphicsQueue)
+                return computeTimeline;
+
+            return (queue == presentQueue && presentQueue != graphicsQueue) ? presentTimeline : graphicsTimeline;
+        }
+
+        // Compute has its own family and overlaps with graphics work
+        bool asyncCompute() const { return indices.compute != indices.graphics; }
+
         VkDevice                            device;
         VkPhysicalDevice                    gpu;
         VkPhysicalDeviceProperties          gpuProperties;
         VkPhysicalDeviceMemoryProperties    memProps;
+        VkPhysicalDeviceFeatures            enabledFeatures;
         VkQueue                             graphicsQueue;
         VkQueue                             presentQueue;
+        VkQueue                             computeQueue;       // The graphics queue when there is no async compute
         VkPipelineCache                     pipelineCache;
         VkCommandPool                       commandPool;
+        MemoryBudget                        memoryBudget;
+        QueueTimeline                       graphicsTimeline;
+        QueueTimeline                       presentTimeline;
+        QueueTimeline                       computeTimeline;
+        DeletionQueue                       deletionQueue;
+        BindlessDescriptors                 *bindless;          // Null without descriptor indexing
+
+        // Only filled in when extensions.descriptorIndexing is set
+        VkPhysicalDeviceDescriptorIndexingPropertiesEXT descriptorIndexingProps;
+
+        struct
+        {
+            bool memoryBudget;
+            bool timelineSemaphore;
+            bool creationFeedback;
+            bool descriptorIndexing;
+            bool drawIndirectCount;
+        }extensions;
+
+        // Only loaded when extensions.drawIndirectCount is set
+        PFN_vkCmdDrawIndexedIndirectCountKHR    cmdDrawIndexedIndirectCount;
 
         struct
         {
             uint32_t graphics;
             uint32_t present;
+            uint32_t compute;
         }indices;
 
     private:
-        bool checkDeviceExtensions(VkPhysicalDevice pd);
-        bool checkSurfaceFormatSupport(VkPhysicalDevice pd, VkSurfaceKHR surface);
-        bool checkQueueIndices(VkPhysicalDevice pd, VkSurfaceKHR surface);
+        struct PendingSubmit
+        {
+            SubmitToken     token;
+            VkCommandBuffer command;
+            bool            free;
+        };
+
+        struct MemoryBlock
+        {
+            VkDeviceSize    size;
+            uint32_t        typeIndex;
+        };
+
+        void collectSubmissions();
+        void loadPipelineCache();
+        void recordPipeline(const VkPipelineCreationFeedbackEXT &feedback, double compileMs);
+        void selectPhysicalDevice(VkInstance instance, VkSurfaceKHR surface, std::string_view gpuOverride);
+        uint64_t scoreDevice(VkPhysicalDevice pd, std::string &reason);
+        bool checkDeviceExtensions(VkPhysicalDevice pd, std::string &reason);
+        bool checkSurfaceFormatSupport(VkPhysicalDevice pd, VkSurfaceKHR surface, std::string &reason);
+        bool checkQueueIndices(VkPhysicalDevice pd, VkSurfaceKHR surface, std::string &reason);
+
+        FencePool                   fences;
+        CommandPools                transientPools;
+        std::deque<PendingSubmit>   pending;
+        std::mutex                  submitMutex;
+
+        std::vector<VkExtensionProperties>                  availableExtensions;
+        std::vector<const char*>                            enabledExtensions;
+        std::unordered_map<VkDeviceMemory, MemoryBlock>     memoryBlocks;
+        std::mutex                                          memoryMutex;
+
+        std::string                                         pipelineCachePath;
+        PipelineCacheStats                                  pipelineCacheStats;
+        uint32_t                                            pipelineCacheSaveInterval;
+        uint32_t                                            pipelinesSinceSave;
+        std::mutex                                          pipelineCacheMutex;
     };
 } // vks
\ No newline at end of file
@@ -0,0 +1,361 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#include "VulkanGpuScene.hpp"
+
+#include <chrono>
+
+namespace vks
+{
+    constexpr uint32_t ObjectBinding = 0;
+    constexpr uint32_t MeshBinding = 1;
+    constexpr uint32_t DrawBinding = 2;
+    constexpr uint32_t CountBinding = 3;
+
+    constexpr VkDeviceSize DrawStride = sizeof(VkDrawIndexedIndirectCommand);
+
+    bool GpuScene::initialise(VulkanDevice *dev,
+                              VkShaderModule cullShader,
+                              uint32_t frameCount,
+                              uint32_t maxObjects,
+                              uint32_t maxMeshes)
+    {
+        device = dev;
+        framesInFlight = frameCount;
+        maxObjectCount = maxObjects;
+        maxMeshCount = maxMeshes;
+        stats = {};
+        stats.indirectCount = device->cmdDrawIndexedIndirectCount != nullptr;
+
+        // The object index reaches the vertex shader through firstInstance
+        if (!device->enabledFeatures.drawIndirectFirstInstance)
+        {
+            std::cout << "Warning, GPU driven draws need drawIndirectFirstInstance" << std::endl;
+            return false;
+        }
+
+        const VkDescriptorSetLayoutBinding bindings[] = {
+                Inits::descriptorSetLayoutBinding(ObjectBinding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT),
+                Inits::descriptorSetLayoutBinding(MeshBinding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT),
+                Inits::descriptorSetLayoutBinding(DrawBinding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT),
+                Inits::descriptorSetLayoutBinding(CountBinding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+        };
+
+        const auto layoutInfo = Inits::descriptorSetLayoutCreateInfo(bindings);
+        vkCreateDescriptorSetLayout(*device, &layoutInfo, nullptr, &setLayout);
+
+        const VkDescriptorPoolSize poolSizes[] = {
+                Inits::descriptorPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, arraysize(bindings) * framesInFlight)
+        };
+
+        const auto poolInfo = Inits::descriptorPoolCreateInfo(poolSizes, framesInFlight);
+        vkCreateDescriptorPool(*device, &poolInfo, nullptr, &descriptorPool);
+
+        if (!kernel.create(device, cullShader, &setLayout, 1, sizeof(CullConstants)))
+            return false;
+
+        // Frames in flight read the buffers written by compute on another queue
+        uint32_t families[2] = { device->indices.graphics, device->indices.compute };
+        const uint32_t familyCount = device->asyncCompute() ? 2 : 1;
+
+        constexpr auto HostVisible = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+        constexpr auto DeviceLocal = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+        meshBuffer.create(device, maxMeshCount * sizeof(MeshData), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                          HostVisible, DeviceLocal, families, familyCount);
+
+        for (uint32_t i = 0; i < framesInFlight; i++)
+        {
+            auto &frame = frames[i];
+
+            // Written from the host only for changed objects, so device local host visible memory pays off
+            frame.objects.create(device, maxObjectCount * sizeof(GpuObject), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                 HostVisible, DeviceLocal, families, familyCount);
+
+            frame.draws.create(device, maxObjectCount * DrawStride,
+                               VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                               DeviceLocal, 0, families, familyCount);
+
+            frame.count.create(device, sizeof(uint32_t),
+                               VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                               DeviceLocal, 0, families, familyCount);
+
+            const auto allocInfo = Inits::descriptorSetAllocateInfo(descriptorPool, &setLayout, 1);
+            vkAllocateDescriptorSets(*device, &allocInfo, &frame.set);
+
+            const VkDescriptorBufferInfo bufferInfos[] = {
+                    Inits::descriptorBufferInfo(frame.objects, 0, VK_WHOLE_SIZE),
+                    Inits::descriptorBufferInfo(meshBuffer, 0, VK_WHOLE_SIZE),
+                    Inits::descriptorBufferInfo(frame.draws, 0, VK_WHOLE_SIZE),
+                    Inits::descriptorBufferInfo(frame.count, 0, VK_WHOLE_SIZE)
+            };
+
+            VkWriteDescriptorSet writes[arraysize(bindings)];
+
+            for (uint32_t binding = 0; binding < arraysize32(writes); binding++)
+                writes[binding] = Inits::writeDescriptorSet(binding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, frame.set, &bufferInfos[binding]);
+
+            vkUpdateDescriptorSets(*device, arraysize32(writes), writes, 0, nullptr);
+
+            frame.dirty.clear();
+            frame.dirty.reserve(maxObjectCount);
+        }
+
+        meshes.reserve(maxMeshCount);
+        objects.reserve(maxObjectCount);
+        dirtyMask.reserve(maxObjectCount);
+        live.reserve(maxObjectCount);
+        return true;
+    }
+
+    void GpuScene::shutdown()
+    {
+        kernel.destroy();
+        meshBuffer.destroy();
+
+        for (uint32_t i = 0; i < framesInFlight; i++)
+        {
+            frames[i].objects.destroy();
+            frames[i].draws.destroy();
+            frames[i].count.destroy();
+        }
+
+        device->deletionQueue.push(descriptorPool);
+        vkDestroyDescriptorSetLayout(*device, setLayout, nullptr);
+
+        meshes.clear();
+        objects.clear();
+        dirtyMask.clear();
+        live.clear();
+        freeObjects.clear();
+    }
+
+    uint32_t GpuScene::addMesh(const GpuMesh &mesh)
+    {
+        if (meshes.size() >= maxMeshCount)
+        {
+            std::cout << "Warning, GPU scene is out of mesh slots" << std::endl;
+            return UINT32_MAX;
+        }
+
+        const auto index = uint32_t(meshes.size());
+        meshes.push_back(mesh);
+
+        auto data = meshBuffer.data<MeshData>();
+        data[index] = { mesh.indexCount, mesh.firstIndex, mesh.vertexOffset, 0 };
+        meshBuffer.flush(index * sizeof(MeshData), sizeof(MeshData));
+
+        stats.meshes = uint32_t(meshes.size());
+        return index;
+    }
+
+    uint32_t GpuScene::addObject(uint32_t mesh, uint32_t material, const mat4x4 &transform)
+    {
+        // The cull shader reads the mesh table at this index with nothing to bound it
+        if (mesh >= meshes.size())
+        {
+            std::cout << "Warning, GPU scene mesh " << mesh << " does not exist" << std::endl;
+            return UINT32_MAX;
+        }
+
+        uint32_t index;
+
+        if (!freeObjects.empty())
+        {
+            index = freeObjects.back();
+            freeObjects.pop_back();
+        }
+        else if (objects.size() < maxObjectCount)
+        {
+            index = uint32_t(objects.size());
+            objects.emplace_back();
+            dirtyMask.push_back(0);
+            live.push_back(0);
+        }
+        else
+        {
+            std::cout << "Warning, GPU scene is out of object slots" << std::endl;
+            return UINT32_MAX;
+        }
+
+        live[index] = 1;
+
+        auto &object = objects[index];
+        object = {};
+        object.transform = transform;
+        object.mesh = mesh;
+        object.material = material;
+        updateSphere(object);
+        markDirty(index);
+
+        stats.objects++;
+        return index;
+    }
+
+    void GpuScene::setTransform(uint32_t object, const mat4x4 &transform)
+    {
+        // A removed object would get its sphere back and pass the cull again
+        if (object >= objects.size() || !live[object])
+            return;
+
+        objects[object].transform = transform;
+        updateSphere(objects[object]);
+        markDirty(object);
+    }
+
+    bool GpuScene::removeObject(uint32_t object)
+    {
+        // A second removal would put the slot on the free list twice and hand it to two objects
+        if (object >= objects.size() || !live[object])
+        {
+            std::cout << "Warning, GPU scene object " << object << " is not in use" << std::endl;
+            return false;
+        }
+
+        // The slot keeps being dispatched over but never passes the cull
+        live[object] = 0;
+        objects[object].sphere[3] = -1.0f;
+        markDirty(object);
+        freeObjects.push_back(object);
+        stats.objects--;
+        return true;
+    }
+
+    void GpuScene::cull(VkCommandBuffer command, uint32_t frame, const mat4x4 &viewProjection)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        auto &slot = frames[frame];
+
+        // The slot's previous frame has completed, so its copy can be patched in place
+        auto mapped = slot.objects.data<GpuObject>();
+        const uint8_t bit = uint8_t(1u << frame);
+
+        for (const auto index : slot.dirty)
+        {
+            mapped[index] = objects[index];
+            dirtyMask[index] &= uint8_t(~bit);
+        }
+
+        if (!slot.dirty.empty())
+            slot.objects.flush();
+
+        stats.uploads = uint32_t(slot.dirty.size());
+        slot.dirty.clear();
+
+        CullConstants constants{};
+        extractPlanes(viewProjection, constants.planes);
+        constants.objectCount = uint32_t(objects.size());
+        constants.compact = stats.indirectCount ? 1 : 0;
+
+        vkCmdFillBuffer(command, slot.count, 0, sizeof(uint32_t), 0);
+
+        VkBufferMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.buffer = slot.count;
+        barrier.offset = 0;
+        barrier.size = VK_WHOLE_SIZE;
+        vkCmdPipelineBarrier(command, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+        kernel.bind(command, &slot.set, 1);
+        kernel.push(command, constants);
+        kernel.dispatchItems(command, constants.objectCount, GroupSize);
+
+        // Covers recording on the graphics queue, across queues the timeline wait orders it instead
+        VkMemoryBarrier drawBarrier{};
+        drawBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        drawBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        drawBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+        vkCmdPipelineBarrier(command, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                             0, 1, &drawBarrier, 0, nullptr, 0, nullptr);
+
+        stats.recordMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void GpuScene::draw(VkCommandBuffer command, uint32_t frame)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        const auto &slot = frames[frame];
+        const auto maxDraws = uint32_t(objects.size());
+
+        if (maxDraws == 0)
+            return;
+
+        if (stats.indirectCount)
+        {
+            device->cmdDrawIndexedIndirectCount(command, slot.draws, 0, slot.count, 0, maxDraws, DrawStride);
+        }
+        else if (device->enabledFeatures.multiDrawIndirect)
+        {
+            vkCmdDrawIndexedIndirect(command, slot.draws, 0, maxDraws, DrawStride);
+        }
+        else
+        {
+            // Last resort, one call per object slot
+            for (uint32_t i = 0; i < maxDraws; i++)
+                vkCmdDrawIndexedIndirect(command, slot.draws, i * DrawStride, 1, DrawStride);
+        }
+
+        stats.recordMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void GpuScene::extractPlanes(mat4x4 viewProjection, float (&planes)[6][4])
+    {
+        // Column major, row r of the matrix is m(0, r) .. m(3, r). Depth is in [0, 1].
+        auto &m = viewProjection;
+
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            planes[0][i] = m(i, 3) + m(i, 0);   // Left
+            planes[1][i] = m(i, 3) - m(i, 0);   // Right
+            planes[2][i] = m(i, 3) + m(i, 1);   // Bottom
+            planes[3][i] = m(i, 3) - m(i, 1);   // Top
+            planes[4][i] = m(i, 2);             // Near
+            planes[5][i] = m(i, 3) - m(i, 2);   // Far
+        }
+
+        for (auto &plane : planes)
+        {
+            const auto length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+            const auto scale = length > 0.0f ? 1.0f / length : 0.0f;
+
+            for (auto &value : plane)
+                value *= scale;
+        }
+    }
+
+    void GpuScene::updateSphere(GpuObject &object)
+    {
+        auto &m = object.transform;
+
+        // The largest axis scale keeps the sphere conservative under non-uniform scaling
+        float maxScale = 0.0f;
+
+        for (uint32_t axis = 0; axis < 3; axis++)
+            maxScale = max(maxScale, m(axis, 0) * m(axis, 0) + m(axis, 1) * m(axis, 1) + m(axis, 2) * m(axis, 2));
+
+        object.sphere[0] = m(3, 0);
+        object.sphere[1] = m(3, 1);
+        object.sphere[2] = m(3, 2);
+        object.sphere[3] = meshes[object.mesh].radius * std::sqrt(maxScale);
+    }
+
+    void GpuScene::markDirty(uint32_t object)
+    {
+        const uint8_t allFrames = uint8_t((1u << framesInFlight) - 1);
+
+        // Each slot uploads the object once, however often it changes in between
+        for (uint32_t i = 0; i < framesInFlight; i++)
+        {
+            if (!(dirtyMask[object] & (1u << i)))
+                frames[i].dirty.push_back(object);
+        }
+
+        dirtyMask[object] = allFrames;
+    }
+} // vks
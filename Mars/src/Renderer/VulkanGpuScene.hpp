@@ -0,0 +1,132 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#pragma once
+
+#include "VulkanBuffer.hpp"
+#include "VulkanCompute.hpp"
+
+namespace vks
+{
+    // Index range of a mesh inside the application's shared vertex and index buffers
+    struct GpuMesh
+    {
+        uint32_t    indexCount;
+        uint32_t    firstIndex;
+        int32_t     vertexOffset;
+        float       radius;             // Bounding sphere around the mesh origin
+    };
+
+    // std430 layout of one object, read by the cull shader and the vertex shader
+    struct GpuObject
+    {
+        mat4x4      transform;
+        float       sphere[4];          // World space centre and radius, a negative radius is never drawn
+        uint32_t    mesh;
+        uint32_t    material;
+        uint32_t    padding[2];
+    };
+
+    static_assert(sizeof(GpuObject) == 96, "GpuObject has to match the std430 layout in gpu_cull.comp");
+
+    // Objects live in storage buffers and are frustum culled by a compute shader (shaders/gpu_cull.comp),
+    // which writes one VkDrawIndexedIndirectCommand per visible object and a draw count. The graphics
+    // pass draws them all with a single vkCmdDrawIndexedIndirectCount, so CPU cost per frame depends on
+    // how many objects changed, not on how many exist.
+    //
+    // Every draw has firstInstance set to its object index, the vertex shader fetches its transform with
+    //  layout(set = N, binding = 0) readonly buffer Objects { GpuObject objects[]; };
+    //  mat4 model = objects[gl_InstanceIndex].transform;
+    // Without VK_KHR_draw_indirect_count every object gets a command and culled ones draw zero instances.
+    class GpuScene
+    {
+        static constexpr uint32_t GroupSize = 64;       // local_size_x of the cull shader
+
+        struct CullConstants
+        {
+            float       planes[6][4];
+            uint32_t    objectCount;
+            uint32_t    compact;
+        };
+
+        struct MeshData
+        {
+            uint32_t    indexCount;
+            uint32_t    firstIndex;
+            int32_t     vertexOffset;
+            uint32_t    padding;
+        };
+
+        struct Frame
+        {
+            Buffer                  objects;
+            Buffer                  draws;
+            Buffer                  count;
+            VkDescriptorSet         set;
+            std::vector<uint32_t>   dirty;      // Objects changed since this slot last uploaded them
+        };
+
+    public:
+        struct Stats
+        {
+            uint32_t    objects;
+            uint32_t    meshes;
+            uint32_t    uploads;            // Objects copied to the GPU by the last cull()
+            bool        indirectCount;
+            double      recordMs;           // CPU time of the last cull() and draw()
+        };
+
+        bool initialise(VulkanDevice *dev,
+                        VkShaderModule cullShader,
+                        uint32_t frameCount,
+                        uint32_t maxObjects,
+                        uint32_t maxMeshes = 1024);
+
+        void shutdown();
+
+        // Meshes cannot change once added, frames in flight may still read them
+        uint32_t addMesh(const GpuMesh &mesh);
+
+        // UINT32_MAX when mesh was not returned by addMesh or every object slot is taken
+        uint32_t addObject(uint32_t mesh, uint32_t material, const mat4x4 &transform);
+        void setTransform(uint32_t object, const mat4x4 &transform);
+
+        // False for an object that was never added or is already removed, its slot may have a new owner
+        bool removeObject(uint32_t object);
+
+        // Uploads changed objects and records the culling dispatch for the frame slot, outside of a
+        // render pass. Works on the graphics queue or an AsyncCompute command buffer.
+        void cull(VkCommandBuffer command, uint32_t frame, const mat4x4 &viewProjection);
+
+        // Inside the render pass, with a pipeline and the shared vertex and index buffers bound
+        void draw(VkCommandBuffer command, uint32_t frame);
+
+        // For the vertex shader's object set
+        const Buffer &getObjectBuffer(uint32_t frame) const { return frames[frame].objects; }
+
+        const Stats &getStats() const { return stats; }
+
+    private:
+        static void extractPlanes(mat4x4 viewProjection, float (&planes)[6][4]);
+
+        void updateSphere(GpuObject &object);
+        void markDirty(uint32_t object);
+
+        VulkanDevice                *device;
+        ComputeKernel               kernel;
+        VkDescriptorSetLayout       setLayout;
+        VkDescriptorPool            descriptorPool;
+        Buffer                      meshBuffer;
+        Frame                       frames[MAX_IMAGES_IN_FLIGHT];
+        uint32_t                    framesInFlight;
+        uint32_t                    maxObjectCount;
+        uint32_t                    maxMeshCount;
+        std::vector<GpuMesh>        meshes;
+        std::vector<GpuObject>      objects;
+        std::vector<uint8_t>        dirtyMask;      // One bit per frame slot still missing the object
+        std::vector<uint8_t>        live;           // Object slots not on freeObjects
+        std::vector<uint32_t>       freeObjects;
+        Stats                       stats;
+    };
+} // vks
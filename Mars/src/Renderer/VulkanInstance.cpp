@@ -5,16 +5,39 @@
 #include "VulkanInstance.hpp"
 #include <GLFW/glfw3.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
 namespace vks
 {
-    void VulkanInstance::initialise(GLFWwindow *window, VkExtent2D screenExtent)
+    void VulkanInstance::initialise(GLFWwindow *window, VkExtent2D screenExtent, uint32_t frameCount, std::string_view gpuOverride)
     {
         extent = screenExtent;
-        currentFrame = 1;
+        requestedExtent = screenExtent;
+        resizePending = false;
+        framesInFlight = clamp(frameCount, 1u, uint32_t(MAX_IMAGES_IN_FLIGHT));
+        currentFrame = framesInFlight - 1;
         imageIndex = 0;
         swapchain = VK_NULL_HANDLE;
         imageCount = 0;
-        vSync = false;
+        presentConfig = { PresentMode::LowLatency, 0, framesInFlight };
+        pendingPresentConfig = presentConfig;
+        presentConfigPending = false;
+        presentStats = {};
+        inputSampled = false;
+        latencyWaitMs = 0.0;
+        frameStats = {};
+        frameStats.framesInFlight = framesInFlight;
+        accumulatedFrameMs = accumulatedWaitMs = 0.0;
+        accumulatedFrames = 0;
+        sampleTier = SampleTier::Medium;
+        targetsDirty = false;
+        resolution = { false, 0.5f, 1.0f, 16.0 };
+        resolutionStats = {};
+        resolutionStats.scale = 1.0f;
+        framesSinceScaleChange = 0;
+        scaled = {};
 
         auto appInfo = Inits::applicationInfo("Mars");
         appInfo.engineVersion = MakeVersionU32(1, 0, 0);
@@ -27,10 +50,26 @@ namespace vks
                 VK_KHR_SURFACE_EXTENSION_NAME
         };
 
+        auto enabledExtensions = std::vector<const char*>(std::begin(RequiredExtensions), std::end(RequiredExtensions));
+
+        {
+            uint32_t count = 0;
+            vkEnumerateInstanceExtensionProperties(nullptr, &count, nullptr);
+            auto extensions = std::vector<VkExtensionProperties>(count);
+            vkEnumerateInstanceExtensionProperties(nullptr, &count, extensions.data());
+
+            // Optional, needed to query heap budgets through VK_EXT_memory_budget
+            for (const auto &extension : extensions)
+            {
+                if (std::strcmp(extension.extensionName, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) == 0)
+                    enabledExtensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+            }
+        }
+
         auto instanceInfo = Inits::instanceCreateInfo();
         instanceInfo.pApplicationInfo = &appInfo;
-        instanceInfo.enabledExtensionCount = arraysize32(RequiredExtensions);
-        instanceInfo.ppEnabledExtensionNames = RequiredExtensions;
+        instanceInfo.enabledExtensionCount = uint32_t(enabledExtensions.size());
+        instanceInfo.ppEnabledExtensionNames = enabledExtensions.data();
 #ifdef ENABLE_VALIDATION
         instanceInfo.enabledLayerCount = arraysize32(ValidationLayers);
         instanceInfo.ppEnabledLayerNames = ValidationLayers;
@@ -42,51 +81,77 @@ namespace vks
 
         glfwCreateWindowSurface(instance, window, VK_NULL_HANDLE, &surface);
 
-        device.initialise(instance, surface);
-
-        {
-            uint32_t count = 0;
-            vkGetPhysicalDeviceSurfaceFormatsKHR(device.gpu, surface, &count, nullptr);
-            auto surfaceFormats = std::vector<VkSurfaceFormatKHR>(count);
-            vkGetPhysicalDeviceSurfaceFormatsKHR(device.gpu, surface, &count, surfaceFormats.data());
-
-            surfaceFormat = *surfaceFormats.begin();
-
-            for (const auto &sFormat: surfaceFormats)
-            {
-                const bool formatCheck = sFormat.format == VK_FORMAT_B8G8R8A8_SRGB;
-                const bool colourSpaceCheck = sFormat.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
-                if (formatCheck && colourSpaceCheck)
-                {
-                    surfaceFormat = sFormat;
-                    break;
-                }
-            }
-        }
+        device.initialise(instance, surface, "pipeline.cache", gpuOverride);
+        descriptorLayouts.initialise(device);
+        descriptorAllocator.initialise(&device, &descriptorLayouts);
+        gpuProfiler.initialise(&device);
+        passQueries.initialise(&device);
+        asyncCompute.initialise(&device, framesInFlight);
 
+        selectSurfaceFormat();
         setupSwapchain();
 
-        sampleCount = Tools::SampleCount(device.gpu);
+        sampleCount = Tools::SampleCount(device.gpu, tierSamples(sampleTier));
         depth.format = Tools::DepthFormat(device.gpu);
         msaa.format = surfaceFormat.format;
 
+        attachmentPolicy = { AttachmentSizing::Exact, 1, {} };
+
+        if (auto mode = glfwGetVideoMode(glfwGetPrimaryMonitor()))
+            attachmentPolicy.maxExtent = { uint32_t(mode->width), uint32_t(mode->height) };
+
+        upscaling = canUpscale();
+        upscaleFilter = Tools::LinearFilterSupport(device.gpu, surfaceFormat.format, VK_IMAGE_TILING_OPTIMAL) ?
+                        VK_FILTER_LINEAR : VK_FILTER_NEAREST;
+
+        attachmentExtent = attachmentCapacity(maxRenderExtent());
         setupMsaa();
         setupDepth();
+        setupScaled();
+        attachmentStats.allocations++;
+        updateAttachmentStats();
         setupRenderPass();
         setupFramebuffers();
         setupSyncPrimitives();
+        renderGraph.initialise(&device, &imageTracker, extent);
 
-        auto cmdInfo = Inits::commandBufferAllocateInfo(device.commandPool, MAX_IMAGES_IN_FLIGHT);
+        auto cmdInfo = Inits::commandBufferAllocateInfo(device.commandPool, framesInFlight);
         vkAllocateCommandBuffers(device, &cmdInfo, commandBuffers);
+        vkAllocateCommandBuffers(device, &cmdInfo, prologueCommands);
+        vkAllocateCommandBuffers(device, &cmdInfo, epilogueCommands);
 
-        buildCommandBuffers();
+        frameTimer = VK_NULL_HANDLE;
+
+        if (gpuProfiler.supported())
+        {
+            VkQueryPoolCreateInfo queryInfo{};
+            queryInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            queryInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+            queryInfo.queryCount = 2 * framesInFlight;
+            vkCreateQueryPool(device, &queryInfo, nullptr, &frameTimer);
+        }
+
+        for (auto &written : frameTimerWritten)
+            written = false;
+
+        renderExtent = extent;
+        resolutionStats.renderExtent = extent;
+
+        lastFrameStart = std::chrono::steady_clock::now();
     }
 
     void VulkanInstance::shutdown()
     {
-        for (size_t i = 0; i < MAX_IMAGES_IN_FLIGHT; i++)
+        device.graphicsTimeline.wait(device.graphicsTimeline.lastSubmitted());
+        gpuProfiler.shutdown();
+        passQueries.shutdown();
+        asyncCompute.shutdown();
+        renderGraph.shutdown();
+        descriptorAllocator.shutdown();
+        descriptorLayouts.shutdown();
+
+        for (size_t i = 0; i < framesInFlight; i++)
         {
-            vkDestroyFence(device, sync.inFlightFences[i], nullptr);
             vkDestroySemaphore(device, sync.renderFinishedSPs[i], nullptr);
             vkDestroySemaphore(device, sync.imageAvailableSPs[i], nullptr);
         }
@@ -98,11 +163,18 @@ namespace vks
 
         vkDestroyImage(device, depth.image, nullptr);
         vkDestroyImageView(device, depth.view, nullptr);
-        vkFreeMemory(device, depth.memory, nullptr);
+        device.freeMemory(depth.memory);
 
         vkDestroyImage(device, msaa.image, nullptr);
         vkDestroyImageView(device, msaa.view, nullptr);
-        vkFreeMemory(device, msaa.memory, nullptr);
+        device.freeMemory(msaa.memory);
+
+        vkDestroyImage(device, scaled.image, nullptr);
+        vkDestroyImageView(device, scaled.view, nullptr);
+        device.freeMemory(scaled.memory);
+
+        if (frameTimer != VK_NULL_HANDLE)
+            vkDestroyQueryPool(device, frameTimer, nullptr);
 
         for (auto &swapchainView : swapchainViews)
             vkDestroyImageView(device, swapchainView, nullptr);
@@ -114,13 +186,46 @@ namespace vks
         vkDestroyInstance(instance, nullptr);
     }
 
-    void VulkanInstance::prepareFrame()
+    bool VulkanInstance::prepareFrame()
     {
-        currentFrame = (currentFrame + 1) % MAX_IMAGES_IN_FLIGHT;
-        vkQueueWaitIdle(device.graphicsQueue);
+        using Clock = std::chrono::steady_clock;
+        using Milliseconds = std::chrono::duration<double, std::milli>;
+
+        // The render pass does not depend on the present mode, so this never goes through a full rebuild
+        if (presentConfigPending)
+        {
+            presentConfig = pendingPresentConfig;
+            presentConfigPending = false;
+
+            // Retried through the resize path, minimised windows cannot have a swapchain
+            if (!recreateSwapchain())
+            {
+                notifyResize(requestedExtent);
+                return false;
+            }
+        }
+
+        if (resizePending && Clock::now() - lastResizeEvent >= ResizeDebounce && !recreateSwapchain())
+            return false;
+
+        currentFrame = (currentFrame + 1) % framesInFlight;
+
+        auto &timeline = device.graphicsTimeline;
 
-        vkWaitForFences(device, 1, &sync.inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
-        vkResetFences(device, 1, &sync.inFlightFences[currentFrame]);
+        auto waitStart = Clock::now();
+        timeline.wait(sync.frameValues[currentFrame]);
+        double waitMs = Milliseconds(Clock::now() - waitStart).count() + latencyWaitMs;
+        latencyWaitMs = 0.0;
+
+        collectLatency();
+        device.memoryBudget.update();
+        device.deletionQueue.collect();
+
+        if (device.bindless != nullptr)
+            device.bindless->collect();
+
+        imageTracker.nextFrame();
+        updateRenderScale();
 
         const auto result = vkAcquireNextImageKHR(device,
                                                   swapchain,
@@ -129,29 +234,74 @@ namespace vks
                                                   VK_NULL_HANDLE,
                                                   &imageIndex);
 
-        if ((result == VK_ERROR_OUT_OF_DATE_KHR) || (result == VK_SUBOPTIMAL_KHR)) {
-            windowResize();
-            return;
+        // An out of date swapchain cannot be presented to at all, a suboptimal one can until the debounce settles
+        if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+            recreateSwapchain();
+            return false;
+        }
+
+        if (result == VK_SUBOPTIMAL_KHR && !resizePending)
+            notifyResize(requestedExtent);
+
+        // Images can come back out of order, so the image may still be in use by another frame slot
+        if (!timeline.isComplete(sync.imageValues[imageIndex]))
+        {
+            waitStart = Clock::now();
+            timeline.wait(sync.imageValues[imageIndex]);
+            waitMs += Milliseconds(Clock::now() - waitStart).count();
         }
+
+        vkResetCommandBuffer(commandBuffers[currentFrame], 0);
+        buildCommandBuffers();
+
+        updateFrameStats(waitMs);
+        return true;
     }
 
     void VulkanInstance::submitFrame()
     {
-        const VkSemaphore imageAvailableSemaphores[] = { sync.imageAvailableSPs[currentFrame] };
         const VkSemaphore renderFinishedSemaphores[] = { sync.renderFinishedSPs[currentFrame] };
-        const VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-
-        VkSubmitInfo submitInfo{};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.pNext = nullptr;
-        submitInfo.pCommandBuffers = commandBuffers;
-        submitInfo.commandBufferCount = arraysize32(commandBuffers);
-        submitInfo.pWaitSemaphores = imageAvailableSemaphores;
-        submitInfo.waitSemaphoreCount = arraysize32(imageAvailableSemaphores);
-        submitInfo.pSignalSemaphores = renderFinishedSemaphores;
-        submitInfo.signalSemaphoreCount = arraysize32(renderFinishedSemaphores);
-        submitInfo.pWaitDstStageMask = waitStages;
-        vkQueueSubmit(device.graphicsQueue, 1, &submitInfo, sync.inFlightFences[currentFrame]);
+
+        recordPrologue();
+        recordEpilogue();
+
+        // Compute work without a queue of its own runs between the prologue and the frame's commands
+        VkCommandBuffer frameCommands[4];
+        uint32_t frameCommandCount = 0;
+        frameCommands[frameCommandCount++] = prologueCommands[currentFrame];
+
+        if (asyncCompute.takeInline(currentFrame, frameCommands[frameCommandCount]))
+            frameCommandCount++;
+
+        frameCommands[frameCommandCount++] = commandBuffers[currentFrame];
+        frameCommands[frameCommandCount++] = epilogueCommands[currentFrame];
+
+        TimelineSubmitInfo submitInfo{};
+        submitInfo.pCommandBuffers = frameCommands;
+        submitInfo.commandBufferCount = frameCommandCount;
+        submitInfo.binaryWait = sync.imageAvailableSPs[currentFrame];
+        submitInfo.binaryWaitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        submitInfo.binarySignal = renderFinishedSemaphores[0];
+
+        if (asyncCompute.takeWait(currentFrame, submitInfo.waits[submitInfo.waitCount]))
+            submitInfo.waitCount++;
+
+        const auto frameValue = device.graphicsTimeline.submit(submitInfo);
+        const auto frameToken = SubmitToken{ &device.graphicsTimeline, frameValue };
+        sync.frameValues[currentFrame] = frameValue;
+        sync.imageValues[imageIndex] = frameValue;
+        device.deletionQueue.stamp(frameToken);
+
+        if (device.bindless != nullptr)
+            device.bindless->stamp(frameToken);
+
+        descriptorAllocator.nextFrame(frameToken);
+        gpuProfiler.endFrame(frameToken);
+        passQueries.endFrame(frameToken);
+
+        // Frames without a waitForFrameLatency() call sampled their input when prepareFrame started
+        latencySamples.push_back({ frameValue, inputSampled ? inputTime : lastFrameStart, presentConfig.mode });
+        inputSampled = false;
 
         VkPresentInfoKHR presentInfo;
         presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -162,54 +312,181 @@ namespace vks
         presentInfo.pSwapchains = &swapchain;
         presentInfo.swapchainCount = 1;
         presentInfo.pImageIndices = &imageIndex;
-        const auto result = vkQueuePresentKHR(device.presentQueue, &presentInfo);
+        const auto result = device.getTimeline(device.presentQueue).present(presentInfo);
+
+        // The next acquire recreates right away if the swapchain is out of date
+        if (((result == VK_ERROR_OUT_OF_DATE_KHR) || (result == VK_SUBOPTIMAL_KHR)) && !resizePending)
+            notifyResize(requestedExtent);
+    }
 
-        if ((result == VK_ERROR_OUT_OF_DATE_KHR) || (result == VK_SUBOPTIMAL_KHR)) {
-            windowResize();
+    void VulkanInstance::setAttachmentPolicy(const AttachmentPolicy &policy)
+    {
+        const auto maxExtent = attachmentPolicy.maxExtent;
+        attachmentPolicy = policy;
+
+        if (attachmentPolicy.maxExtent.width == 0 || attachmentPolicy.maxExtent.height == 0)
+            attachmentPolicy.maxExtent = maxExtent;
+
+        attachmentPolicy.bucketSize = max(attachmentPolicy.bucketSize, 1u);
+        notifyResize(requestedExtent);
+    }
+
+    void VulkanInstance::setSampleTier(SampleTier tier)
+    {
+        sampleTier = tier;
+        targetsDirty = true;
+        notifyResize(requestedExtent);
+    }
+
+    void VulkanInstance::setDynamicResolution(const DynamicResolution &settings)
+    {
+        resolution = settings;
+        resolution.minScale = max(resolution.minScale, 0.1f);
+        resolution.maxScale = max(resolution.maxScale, resolution.minScale);
+        resolutionStats.scale = clamp(resolutionStats.scale, resolution.minScale, resolution.maxScale);
+        framesSinceScaleChange = 0;
+
+        // Offscreen targets are sized for maxScale, so bounds changes need a rebuild as well
+        targetsDirty = true;
+        notifyResize(requestedExtent);
+    }
+
+    void VulkanInstance::setPresentConfig(const PresentConfig &config)
+    {
+        pendingPresentConfig = config;
+        pendingPresentConfig.maxQueuedFrames = clamp(pendingPresentConfig.maxQueuedFrames, 1u, framesInFlight);
+        presentConfigPending = true;
+    }
+
+    void VulkanInstance::waitForFrameLatency()
+    {
+        using Clock = std::chrono::steady_clock;
+
+        // currentFrame holds the frame submitted last, the one submitted k frames earlier is k slots back
+        const auto queued = presentConfig.maxQueuedFrames - 1;
+        const auto slot = (currentFrame + framesInFlight - queued) % framesInFlight;
+
+        const auto waitStart = Clock::now();
+        device.graphicsTimeline.wait(sync.frameValues[slot]);
+        inputTime = Clock::now();
+        inputSampled = true;
+        latencyWaitMs += std::chrono::duration<double, std::milli>(inputTime - waitStart).count();
+
+        collectLatency();
+    }
+
+    void VulkanInstance::notifyResize(VkExtent2D newExtent)
+    {
+        requestedExtent = newExtent;
+        lastResizeEvent = std::chrono::steady_clock::now();
+        resizePending = true;
+    }
+
+    void VulkanInstance::updateFrameStats(double waitMs)
+    {
+        constexpr uint32_t StatsWindow = 120;
+
+        const auto frameStart = std::chrono::steady_clock::now();
+        accumulatedFrameMs += std::chrono::duration<double, std::milli>(frameStart - lastFrameStart).count();
+        accumulatedWaitMs += waitMs;
+        lastFrameStart = frameStart;
+
+        if (++accumulatedFrames < StatsWindow)
             return;
-        }
+
+        frameStats.frameMs = accumulatedFrameMs / accumulatedFrames;
+        frameStats.waitMs = accumulatedWaitMs / accumulatedFrames;
+        frameStats.overlap = 1.0 - frameStats.waitMs / max(frameStats.frameMs, 0.001);
+        frameStats.framesInFlight = framesInFlight;
+
+#ifdef ENABLE_VALIDATION
+        std::cout << "Frame " << frameStats.frameMs << " ms, GPU wait " << frameStats.waitMs
+                  << " ms, CPU/GPU overlap " << frameStats.overlap * 100.0 << "% ("
+                  << framesInFlight << " frames in flight)" << std::endl;
+#endif
+        accumulatedFrameMs = accumulatedWaitMs = 0.0;
+        accumulatedFrames = 0;
     }
 
-    void VulkanInstance::setupSwapchain()
+    void VulkanInstance::selectSurfaceFormat()
     {
-        VkSwapchainKHR oldSwapchain = swapchain;
+        uint32_t count = 0;
+        vkGetPhysicalDeviceSurfaceFormatsKHR(device.gpu, surface, &count, nullptr);
+        auto surfaceFormats = std::vector<VkSurfaceFormatKHR>(count);
+        vkGetPhysicalDeviceSurfaceFormatsKHR(device.gpu, surface, &count, surfaceFormats.data());
 
+        surfaceFormat = *surfaceFormats.begin();
+
+        for (const auto &sFormat: surfaceFormats)
+        {
+            const bool formatCheck = sFormat.format == VK_FORMAT_B8G8R8A8_SRGB;
+            const bool colourSpaceCheck = sFormat.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
+            if (formatCheck && colourSpaceCheck)
+            {
+                surfaceFormat = sFormat;
+                break;
+            }
+        }
+    }
+
+    bool VulkanInstance::setupSwapchain()
+    {
         VkSurfaceCapabilitiesKHR capabilities;
         vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device.gpu, surface, &capabilities);
 
-        VkPresentModeKHR swapchainPresentMode = VK_PRESENT_MODE_FIFO_KHR;
+        // Minimised, there is nothing to present to until the window comes back
+        if (capabilities.currentExtent.width == 0 || capabilities.currentExtent.height == 0)
+            return false;
 
         uint32_t presentModeCount;
         vkGetPhysicalDeviceSurfacePresentModesKHR(device.gpu, surface, &presentModeCount, nullptr);
         std::vector<VkPresentModeKHR> presentModes(presentModeCount);
         vkGetPhysicalDeviceSurfacePresentModesKHR(device.gpu, surface, &presentModeCount, presentModes.data());
 
-        if (!vSync)
+        // In order of preference, FIFO is the fallback every surface supports
+        VkPresentModeKHR candidates[2] = { VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_KHR };
+
+        if (presentConfig.mode == PresentMode::LowLatency)
+        {
+            candidates[0] = VK_PRESENT_MODE_MAILBOX_KHR;
+            candidates[1] = VK_PRESENT_MODE_IMMEDIATE_KHR;
+        }
+        else if (presentConfig.mode == PresentMode::Throughput)
+        {
+            candidates[0] = VK_PRESENT_MODE_IMMEDIATE_KHR;
+            candidates[1] = VK_PRESENT_MODE_MAILBOX_KHR;
+        }
+
+        presentMode = VK_PRESENT_MODE_FIFO_KHR;
+
+        for (auto candidate : candidates)
         {
-            for (auto mode : presentModes)
+            if (std::find(presentModes.begin(), presentModes.end(), candidate) != presentModes.end())
             {
-                if(mode == VK_PRESENT_MODE_MAILBOX_KHR)
-                {
-                    swapchainPresentMode = mode;
-                    break;
-                }
-                if(mode == VK_PRESENT_MODE_IMMEDIATE_KHR)
-                    swapchainPresentMode = mode;
+                presentMode = candidate;
+                break;
             }
         }
 
-        auto desiredImageCount = capabilities.minImageCount + 1;
+        auto desiredImageCount = presentConfig.imageCount > 0 ? presentConfig.imageCount : capabilities.minImageCount + 1;
+        desiredImageCount = max(desiredImageCount, capabilities.minImageCount);
         if((capabilities.maxImageCount > 0) && (desiredImageCount > capabilities.maxImageCount))
             desiredImageCount = capabilities.maxImageCount;
 
-        auto info = Inits::swapchainCreateInfo(VK_NULL_HANDLE);
+        // Handing over the old swapchain lets the presentation engine reuse its resources
+        // and keeps presenting the images already queued on it
+        auto info = Inits::swapchainCreateInfo(swapchain);
         info.minImageCount = desiredImageCount;
         info.surface = surface;
         info.imageFormat = surfaceFormat.format;
         info.imageColorSpace = surfaceFormat.colorSpace;
 
+        // Upscaling blits into the swapchain image
+        swapchainUsage = capabilities.supportedUsageFlags & (VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+        info.imageUsage = swapchainUsage;
+
         if(capabilities.currentExtent.width == UINT32_MAX)
-            info.imageExtent = extent;
+            info.imageExtent = requestedExtent;
         else
             info.imageExtent = capabilities.currentExtent;
 
@@ -219,7 +496,6 @@ namespace vks
         else
             info.preTransform = capabilities.currentTransform;
 
-        info.preTransform = capabilities.currentTransform;
         info.presentMode = presentMode;
 
         const uint32_t queueFamilyIndices[] = {
@@ -240,22 +516,27 @@ namespace vks
             info.pQueueFamilyIndices = nullptr;
         }
 
-        vkCreateSwapchainKHR(device, &info, nullptr, &swapchain);
+        // The next submission waits on an image of the new swapchain, so once it completes every
+        // earlier frame that could still reference the old one has finished too. That is the
+        // deletion queue's default key.
+        device.deletionQueue.push(swapchain);
 
-        // If an existing swap chain is re-created, destroy the old swap chain
-        // This also cleans up all the presentable images
-        if (oldSwapchain != VK_NULL_HANDLE)
-        {
-            for (auto imageView : swapchainViews)
-                vkDestroyImageView(device, imageView, nullptr);
+        for (auto view : swapchainViews)
+            device.deletionQueue.push(view);
 
-            vkDestroySwapchainKHR(device, oldSwapchain, VK_NULL_HANDLE);
-        }
+        for (auto image : swapchainImages)
+            imageTracker.untrack(image);
+
+        vkCreateSwapchainKHR(device, &info, nullptr, &swapchain);
+        extent = info.imageExtent;
 
         vkGetSwapchainImagesKHR(device, swapchain, &imageCount, nullptr);
         swapchainImages.resize(imageCount);
         vkGetSwapchainImagesKHR(device, swapchain, &imageCount, swapchainImages.data());
         swapchainViews.resize(imageCount);
+        sync.imageValues.assign(imageCount, 0);
+        presentStats.activeMode = presentMode;
+        presentStats.imageCount = imageCount;
 
         for (size_t i = 0; i < swapchainViews.size(); i++)
         {
@@ -264,14 +545,93 @@ namespace vks
             imageViewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
             imageViewInfo.image = swapchainImages[i];
             vkCreateImageView(device, &imageViewInfo, nullptr, &swapchainViews[i]);
+            imageTracker.track(swapchainImages[i], VK_IMAGE_ASPECT_COLOR_BIT);
+        }
+
+        return true;
+    }
+
+    VkExtent2D VulkanInstance::attachmentCapacity(VkExtent2D target) const
+    {
+        const auto roundUp = [](uint32_t value, uint32_t multiple) {
+            return (value + multiple - 1) / multiple * multiple;
+        };
+
+        VkExtent2D capacity = target;
+
+        switch (attachmentPolicy.sizing)
+        {
+            case AttachmentSizing::Bucketed:
+            {
+                capacity.width = roundUp(target.width, attachmentPolicy.bucketSize);
+                capacity.height = roundUp(target.height, attachmentPolicy.bucketSize);
+                break;
+            }
+            case AttachmentSizing::Display:
+            {
+                capacity.width = max(target.width, attachmentPolicy.maxExtent.width);
+                capacity.height = max(target.height, attachmentPolicy.maxExtent.height);
+                break;
+            }
+            default: break;
+        }
+
+        // Never round past what the device supports, the target itself always fits
+        const auto limit = device.gpuProperties.limits.maxImageDimension2D;
+        capacity.width = max(min(capacity.width, limit), target.width);
+        capacity.height = max(min(capacity.height, limit), target.height);
+        return capacity;
+    }
+
+    bool VulkanInstance::canUpscale() const
+    {
+        if (!resolution.enabled)
+            return false;
+
+        if (!(swapchainUsage & VK_IMAGE_USAGE_TRANSFER_DST_BIT) || !Tools::BlitCmdSupportOptimal(device.gpu, surfaceFormat.format))
+        {
+            std::cout << "Warning, dynamic resolution needs blits to the swapchain, rendering at full resolution" << std::endl;
+            return false;
         }
+
+        return true;
+    }
+
+    VkExtent2D VulkanInstance::maxRenderExtent() const
+    {
+        if (!upscaling)
+            return extent;
+
+        return {
+            max(uint32_t(std::ceil(float(extent.width) * resolution.maxScale)), 1u),
+            max(uint32_t(std::ceil(float(extent.height) * resolution.maxScale)), 1u)
+        };
+    }
+
+    void VulkanInstance::updateAttachmentStats()
+    {
+        const auto target = maxRenderExtent();
+        const double used = double(target.width) * double(target.height);
+        const double allocated = double(attachmentExtent.width) * double(attachmentExtent.height);
+
+        attachmentStats.allocatedBytes = msaa.size + depth.size + scaled.size;
+        attachmentStats.wastedBytes = VkDeviceSize(double(attachmentStats.allocatedBytes) * (1.0 - used / max(allocated, 1.0)));
     }
 
     void VulkanInstance::setupMsaa()
     {
+        if (sampleCount == VK_SAMPLE_COUNT_1_BIT)
+        {
+            msaa.image = VK_NULL_HANDLE;
+            msaa.view = VK_NULL_HANDLE;
+            msaa.memory = VK_NULL_HANDLE;
+            msaa.size = 0;
+            return;
+        }
+
         auto imageInfo = Inits::imageCreateInfo();
         imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-        imageInfo.extent = {extent.width, extent.height, 1};
+        imageInfo.extent = {attachmentExtent.width, attachmentExtent.height, 1};
         imageInfo.samples = sampleCount;
         imageInfo.format = surfaceFormat.format;
         imageInfo.usage = VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
@@ -279,9 +639,13 @@ namespace vks
 
         VkMemoryRequirements memReqs{};
         vkGetImageMemoryRequirements(device, msaa.image, &memReqs);
+        msaa.size = memReqs.size;
 
-        auto allocInfo = device.getMemoryAllocInfo(memReqs, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-        vkAllocateMemory(device, &allocInfo, nullptr, &msaa.memory);
+        // Transient attachments never leave tile memory on tilers, lazily allocated memory saves the backing store
+        auto allocInfo = device.getMemoryAllocInfo(memReqs,
+                                                   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                   VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT);
+        device.allocateMemory(allocInfo, &msaa.memory);
         vkBindImageMemory(device, msaa.image, msaa.memory, 0);
 
         auto viewInfo = Inits::imageViewCreateInfo();
@@ -295,7 +659,7 @@ namespace vks
     {
         auto imageInfo = Inits::imageCreateInfo();
         imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-        imageInfo.extent = {extent.width, extent.height, 1};
+        imageInfo.extent = {attachmentExtent.width, attachmentExtent.height, 1};
         imageInfo.samples = sampleCount;
         imageInfo.format = Tools::DepthFormat(device.gpu);
         imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
@@ -303,22 +667,64 @@ namespace vks
 
         VkMemoryRequirements memReqs{};
         vkGetImageMemoryRequirements(device, depth.image, &memReqs);
+        depth.size = memReqs.size;
 
         auto allocInfo = device.getMemoryAllocInfo(memReqs, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-        vkAllocateMemory(device, &allocInfo, nullptr, &depth.memory);
+        device.allocateMemory(allocInfo, &depth.memory);
         vkBindImageMemory(device, depth.image, depth.memory, 0);
 
         auto viewInfo = Inits::imageViewCreateInfo();
         viewInfo.image = depth.image;
         viewInfo.format = imageInfo.format;
-        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
         vkCreateImageView(device, &viewInfo, nullptr, &depth.view);
     }
 
+    void VulkanInstance::setupScaled()
+    {
+        scaled.format = surfaceFormat.format;
+
+        if (!upscaling)
+        {
+            scaled.image = VK_NULL_HANDLE;
+            scaled.view = VK_NULL_HANDLE;
+            scaled.memory = VK_NULL_HANDLE;
+            scaled.size = 0;
+            return;
+        }
+
+        auto imageInfo = Inits::imageCreateInfo();
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.extent = {attachmentExtent.width, attachmentExtent.height, 1};
+        imageInfo.format = scaled.format;
+        imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        vkCreateImage(device, &imageInfo, nullptr, &scaled.image);
+
+        VkMemoryRequirements memReqs{};
+        vkGetImageMemoryRequirements(device, scaled.image, &memReqs);
+        scaled.size = memReqs.size;
+
+        auto allocInfo = device.getMemoryAllocInfo(memReqs, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        device.allocateMemory(allocInfo, &scaled.memory);
+        vkBindImageMemory(device, scaled.image, scaled.memory, 0);
+
+        auto viewInfo = Inits::imageViewCreateInfo();
+        viewInfo.image = scaled.image;
+        viewInfo.format = imageInfo.format;
+        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        vkCreateImageView(device, &viewInfo, nullptr, &scaled.view);
+
+        imageTracker.track(scaled.image, VK_IMAGE_ASPECT_COLOR_BIT);
+    }
+
     void VulkanInstance::setupRenderPass()
     {
+        // The upscale blit reads the target afterwards, otherwise it is the swapchain image itself
+        const auto targetLayout = getTargetLayout();
+        const bool multisampled = sampleCount != VK_SAMPLE_COUNT_1_BIT;
+
         auto colourAttachment = Inits::attachmentDescription(msaa.format);
-        colourAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        colourAttachment.finalLayout = multisampled ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : targetLayout;
         colourAttachment.samples = sampleCount;
 
         auto depthAttachment = Inits::attachmentDescription(depth.format);
@@ -326,7 +732,7 @@ namespace vks
         depthAttachment.samples = sampleCount;
 
         auto colourResolve = Inits::attachmentDescription(msaa.format);
-        colourResolve.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        colourResolve.finalLayout = targetLayout;
         colourResolve.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
         colourResolve.samples = VK_SAMPLE_COUNT_1_BIT;
 
@@ -346,7 +752,7 @@ namespace vks
         subpass.colorAttachmentCount = 1;
         subpass.pColorAttachments = &colourAttachmentRef;
         subpass.pDepthStencilAttachment = &depthAttachmentRef;
-        subpass.pResolveAttachments = &colourResolveRef;
+        subpass.pResolveAttachments = multisampled ? &colourResolveRef : nullptr;
 
         VkSubpassDependency dependencies[2];
         dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
@@ -357,39 +763,54 @@ namespace vks
         dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
         dependencies[0].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
 
+        // Render graph passes and the upscale blit synchronise on colour output, the final layout
+        // transition has to happen before it rather than only before bottom of pipe
         dependencies[1].srcSubpass = 0;
         dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
         dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-        dependencies[1].dstStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+        dependencies[1].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
         dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-        dependencies[1].dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+        dependencies[1].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                        VK_ACCESS_MEMORY_READ_BIT;
         dependencies[1].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
 
         VkRenderPassCreateInfo renderPassInfo{};
         renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-        renderPassInfo.attachmentCount = arraysize32(attachments);
+        renderPassInfo.attachmentCount = multisampled ? arraysize32(attachments) : 2;
         renderPassInfo.pAttachments = attachments;
         renderPassInfo.subpassCount = 1;
         renderPassInfo.pSubpasses = &subpass;
         renderPassInfo.dependencyCount = arraysize32(dependencies);
         renderPassInfo.pDependencies = dependencies;
         vkCreateRenderPass(device, &renderPassInfo, nullptr, &renderPass);
+        renderPassChanged();
     }
 
     void VulkanInstance::setupFramebuffers()
     {
+        const bool multisampled = sampleCount != VK_SAMPLE_COUNT_1_BIT;
+        const uint32_t targetIndex = multisampled ? 2 : 0;
+
+        // The offscreen target is shared by every swapchain image
+        const auto framebufferExtent = upscaling ? attachmentExtent : extent;
+
         VkImageView attachments[3] = { msaa.view, depth.view };
 
         auto framebufferInfo = Inits::framebufferCreateInfo();
         framebufferInfo.renderPass = renderPass;
-        framebufferInfo.attachmentCount = arraysize32(attachments);
+        framebufferInfo.attachmentCount = multisampled ? arraysize32(attachments) : 2;
         framebufferInfo.pAttachments = attachments;
-        framebufferInfo.width = extent.width;
-        framebufferInfo.height = extent.height;
+        framebufferInfo.width = framebufferExtent.width;
+        framebufferInfo.height = framebufferExtent.height;
+
+        for (auto framebuffer : framebuffers)
+            device.deletionQueue.push(framebuffer);
+
+        framebuffers.resize(swapchainViews.size());
 
         for (size_t i = 0; i < framebuffers.size(); i++)
         {
-            attachments[2] = swapchainViews[i];
+            attachments[targetIndex] = upscaling ? scaled.view : swapchainViews[i];
             vkCreateFramebuffer(device, &framebufferInfo, nullptr, &framebuffers[i]);
         }
     }
@@ -397,31 +818,233 @@ namespace vks
     void VulkanInstance::setupSyncPrimitives()
     {
         const auto semaphoreInfo = Inits::semaphoreCreateInfo();
-        const auto fenceInfo = Inits::fenceCreateInfo(VK_FENCE_CREATE_SIGNALED_BIT);
 
-        for (size_t i = 0; i < MAX_IMAGES_IN_FLIGHT; i++)
+        for (size_t i = 0; i < framesInFlight; i++)
         {
             vkCreateSemaphore(device, &semaphoreInfo, nullptr, &sync.imageAvailableSPs[i]);
             vkCreateSemaphore(device, &semaphoreInfo, nullptr, &sync.renderFinishedSPs[i]);
-            vkCreateFence(device, &fenceInfo, nullptr, &sync.inFlightFences[i]);
+            sync.frameValues[i] = 0;
         }
     }
 
-    void VulkanInstance::windowResize()
+    bool VulkanInstance::recreateSwapchain()
     {
-        vkDeviceWaitIdle(device);
+        const auto oldExtent = extent;
+        const auto oldFormat = surfaceFormat.format;
 
-        setupSwapchain();
+        selectSurfaceFormat();
 
-        for (auto framebuffer : framebuffers)
-            vkDestroyFramebuffer(device, framebuffer, nullptr);
+        if (!setupSwapchain())
+            return false;
+
+        resizePending = false;
+
+        const bool formatChanged = surfaceFormat.format != oldFormat;
+        const bool extentChanged = extent.width != oldExtent.width || extent.height != oldExtent.height;
+        const bool layoutChanged = formatChanged || targetsDirty;
 
-        for (auto command : commandBuffers)
-            vkResetCommandBuffer(command, VK_COMMAND_BUFFER_RESET_RELEASE_RESOURCES_BIT);
+        if (layoutChanged)
+        {
+            sampleCount = Tools::SampleCount(device.gpu, tierSamples(sampleTier));
+            upscaling = canUpscale();
+            upscaleFilter = Tools::LinearFilterSupport(device.gpu, surfaceFormat.format, VK_IMAGE_TILING_OPTIMAL) ?
+                            VK_FILTER_LINEAR : VK_FILTER_NEAREST;
+        }
+
+        const auto capacity = attachmentCapacity(maxRenderExtent());
+        const bool capacityChanged = capacity.width != attachmentExtent.width || capacity.height != attachmentExtent.height;
+
+        // Attachments are only replaced when they no longer match the policy's size for the new extent,
+        // otherwise rendering just covers a smaller part of them
+        if (layoutChanged || capacityChanged)
+        {
+            retireAttachment(msaa);
+            retireAttachment(depth);
+            retireAttachment(scaled);
+            msaa.format = surfaceFormat.format;
+            attachmentExtent = capacity;
+            setupMsaa();
+            setupDepth();
+            setupScaled();
+            attachmentStats.allocations++;
+        }
+        else if (extentChanged)
+        {
+            attachmentStats.reuses++;
+        }
 
+        updateAttachmentStats();
+
+        if (layoutChanged)
+        {
+            device.deletionQueue.push(renderPass);
+            setupRenderPass();
+        }
+
+        targetsDirty = false;
         setupFramebuffers();
-        setupMsaa();
-        setupDepth();
-        setupRenderPass();
+
+        // Cached framebuffers may reference the retired swapchain views
+        renderGraph.setExtent(extent);
+        renderGraph.invalidate();
+        return true;
+    }
+
+    void VulkanInstance::updateRenderScale()
+    {
+        // This frame slot's previous submission has completed, so its timestamps are available
+        if (frameTimer != VK_NULL_HANDLE && frameTimerWritten[currentFrame])
+        {
+            uint64_t timestamps[2] = {};
+            const auto result = vkGetQueryPoolResults(device, frameTimer, 2 * currentFrame, 2, sizeof(timestamps),
+                                                      timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+            if (result == VK_SUCCESS)
+            {
+                const auto gpuMs = gpuProfiler.ticksToMs(timestamps[0], timestamps[1]);
+                auto &smoothed = resolutionStats.gpuMs;
+                smoothed = smoothed > 0.0 ? smoothed + (gpuMs - smoothed) * 0.1 : gpuMs;
+            }
+        }
+
+        auto &scale = resolutionStats.scale;
+
+        if (!upscaling)
+        {
+            scale = 1.0f;
+        }
+        else if (++framesSinceScaleChange >= ScaleAdjustInterval && resolutionStats.gpuMs > 0.0)
+        {
+            const double budget = resolution.targetGpuMs / resolutionStats.gpuMs;
+
+            // Over budget scales down right away, scaling back up waits for some headroom
+            if (budget < 1.0 || budget > ScaleUpHeadroom)
+            {
+                // GPU time follows the pixel count, which is the square of the scale
+                auto next = scale * float(std::sqrt(budget));
+                next = clamp(next, scale * (1.0f - ScaleStep), scale * (1.0f + ScaleStep));
+                next = clamp(next, resolution.minScale, resolution.maxScale);
+
+                if (std::abs(next - scale) >= 0.01f)
+                {
+                    scale = next;
+                    resolutionStats.adjustments++;
+                }
+            }
+
+            framesSinceScaleChange = 0;
+        }
+
+        const auto capacity = upscaling ? attachmentExtent : extent;
+        renderExtent.width = clamp(uint32_t(float(extent.width) * scale), 1u, capacity.width);
+        renderExtent.height = clamp(uint32_t(float(extent.height) * scale), 1u, capacity.height);
+        resolutionStats.renderExtent = renderExtent;
+    }
+
+    void VulkanInstance::recordPrologue()
+    {
+        const auto command = prologueCommands[currentFrame];
+        vkResetCommandBuffer(command, 0);
+
+        const auto beginInfo = Inits::commandBufferBeginInfo(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+        vkBeginCommandBuffer(command, &beginInfo);
+
+        if (frameTimer != VK_NULL_HANDLE)
+        {
+            vkCmdResetQueryPool(command, frameTimer, 2 * currentFrame, 2);
+            vkCmdWriteTimestamp(command, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frameTimer, 2 * currentFrame);
+        }
+
+        vkEndCommandBuffer(command);
+    }
+
+    void VulkanInstance::recordEpilogue()
+    {
+        const auto command = epilogueCommands[currentFrame];
+        vkResetCommandBuffer(command, 0);
+
+        const auto beginInfo = Inits::commandBufferBeginInfo(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+        vkBeginCommandBuffer(command, &beginInfo);
+
+        if (upscaling)
+        {
+            const auto target = swapchainImages[imageIndex];
+
+            // The render pass leaves the offscreen target in transfer source layout. The swapchain image
+            // is only available from the acquire semaphore's wait stage on.
+            imageTracker.setState(scaled.image, { VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                                  VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                                                  VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT });
+            imageTracker.setState(target, { VK_IMAGE_LAYOUT_UNDEFINED, 0, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT });
+
+            imageTracker.require(scaled.image, { VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                                 VK_ACCESS_TRANSFER_READ_BIT,
+                                                 VK_PIPELINE_STAGE_TRANSFER_BIT });
+            imageTracker.require(target, { VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                           VK_ACCESS_TRANSFER_WRITE_BIT,
+                                           VK_PIPELINE_STAGE_TRANSFER_BIT });
+            imageTracker.flush(command);
+
+            VkImageBlit region{};
+            region.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+            region.srcOffsets[1] = { int32_t(renderExtent.width), int32_t(renderExtent.height), 1 };
+            region.dstSubresource = region.srcSubresource;
+            region.dstOffsets[1] = { int32_t(extent.width), int32_t(extent.height), 1 };
+
+            vkCmdBlitImage(command,
+                           scaled.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           target, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           1, &region, upscaleFilter);
+
+            imageTracker.require(target, { VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, 0, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT });
+            imageTracker.flush(command);
+        }
+
+        if (frameTimer != VK_NULL_HANDLE)
+            vkCmdWriteTimestamp(command, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frameTimer, 2 * currentFrame + 1);
+
+        vkEndCommandBuffer(command);
+        frameTimerWritten[currentFrame] = frameTimer != VK_NULL_HANDLE;
+    }
+
+    void VulkanInstance::collectLatency()
+    {
+        constexpr uint32_t LatencyWindow = 60;
+
+        const auto completed = device.graphicsTimeline.completedValue();
+        const auto now = std::chrono::steady_clock::now();
+
+        // Frames complete in submission order, the front is always the oldest
+        while (!latencySamples.empty() && latencySamples.front().frameValue <= completed)
+        {
+            const auto &sample = latencySamples.front();
+            const auto mode = uint32_t(sample.mode);
+            const auto latencyMs = std::chrono::duration<double, std::milli>(now - sample.inputTime).count();
+
+            auto &average = presentStats.latencyMs[mode];
+            auto &count = presentStats.samples[mode];
+            count++;
+            average += (latencyMs - average) / double(min(count, LatencyWindow));
+
+            latencySamples.pop_front();
+        }
+    }
+
+    VkSampleCountFlagBits VulkanInstance::tierSamples(SampleTier tier)
+    {
+        switch (tier)
+        {
+            case SampleTier::Low: return VK_SAMPLE_COUNT_2_BIT;
+            case SampleTier::Medium: return VK_SAMPLE_COUNT_4_BIT;
+            case SampleTier::High: return VK_SAMPLE_COUNT_8_BIT;
+            default: return VK_SAMPLE_COUNT_1_BIT;
+        }
+    }
+
+    void VulkanInstance::retireAttachment(FramebufferAttachment &attachment)
+    {
+        imageTracker.untrack(attachment.image);
+        device.deletionQueue.push(attachment.view);
+        device.deletionQueue.push(attachment.image);
+        device.deletionQueue.push(attachment.memory);
     }
 } // vks
\ No newline at end of file
@@ -5,6 +5,15 @@
 #pragma once
 
 #include "VulkanDevice.hpp"
+#include "VulkanBindless.hpp"
+#include "VulkanCompute.hpp"
+#include "VulkanDescriptors.hpp"
+#include "VulkanProfiler.hpp"
+#include "VulkanQueries.hpp"
+#include "VulkanRenderGraph.hpp"
+
+#include <chrono>
+#include <deque>
 
 struct GLFWwindow;
 
@@ -16,41 +25,221 @@ namespace vks
         VkImageView         view;
         VkDeviceMemory      memory;
         VkFormat            format;
+        VkDeviceSize        size;
+    };
+
+    enum class AttachmentSizing
+    {
+        Exact,          // Reallocate on every resize
+        Bucketed,       // Round up to bucketSize, resizes within a bucket reuse the images
+        Display         // Allocate for maxExtent (the primary monitor by default) once
+    };
+
+    struct AttachmentPolicy
+    {
+        AttachmentSizing    sizing;
+        uint32_t            bucketSize;
+        VkExtent2D          maxExtent;
     };
 
+    struct AttachmentStats
+    {
+        VkDeviceSize        allocatedBytes;     // MSAA and depth memory currently held
+        VkDeviceSize        wastedBytes;        // Part of it outside the rendered area
+        uint32_t            allocations;
+        uint32_t            reuses;             // Resizes that kept the existing attachments
+    };
+
+    // Explicit MSAA quality, clamped to what the device supports
+    enum class SampleTier
+    {
+        Off,            // Renders straight into the target, no resolve
+        Low,            // 2x
+        Medium,         // 4x
+        High            // 8x
+    };
+
+    struct DynamicResolution
+    {
+        bool                enabled;
+        float               minScale;           // Per axis, relative to the swapchain extent
+        float               maxScale;
+        double              targetGpuMs;        // GPU frame time the render scale is steered towards
+    };
+
+    struct ResolutionStats
+    {
+        float               scale;
+        VkExtent2D          renderExtent;
+        double              gpuMs;              // Smoothed, zero without timestamp support
+        uint32_t            adjustments;
+    };
+
+    enum class PresentMode
+    {
+        LowLatency,     // Mailbox, newest frame wins without tearing, falls back to immediate
+        Throughput,     // Immediate, never blocks on the display but may tear, falls back to mailbox
+        Vsync           // FIFO, always supported
+    };
+
+    constexpr uint32_t PRESENT_MODE_COUNT = 3;
+
+    struct PresentConfig
+    {
+        PresentMode         mode;
+        uint32_t            imageCount;         // Zero requests one more than the surface minimum
+        uint32_t            maxQueuedFrames;    // Frames still on the GPU when input is sampled, 1 to frames in flight
+    };
+
+    // Latency is measured from waitForFrameLatency() to the CPU observing the frame's completion on the
+    // graphics timeline. It excludes scan-out, but is comparable between modes on the same display.
+    struct PresentStats
+    {
+        VkPresentModeKHR    activeMode;
+        uint32_t            imageCount;
+        double              latencyMs[PRESENT_MODE_COUNT];  // Smoothed per PresentMode, zero until measured
+        uint32_t            samples[PRESENT_MODE_COUNT];
+    };
+
+    // Binary semaphores are only used where the swapchain requires them, frame completion
+    // is tracked as values on the graphics queue timeline
     struct SyncObjects
     {
-        VkSemaphore         imageAvailableSPs[MAX_IMAGES_IN_FLIGHT];
-        VkSemaphore         renderFinishedSPs[MAX_IMAGES_IN_FLIGHT];
-        VkFence             inFlightFences[MAX_IMAGES_IN_FLIGHT];
+        VkSemaphore             imageAvailableSPs[MAX_IMAGES_IN_FLIGHT];
+        VkSemaphore             renderFinishedSPs[MAX_IMAGES_IN_FLIGHT];
+        uint64_t                frameValues[MAX_IMAGES_IN_FLIGHT];
+        std::vector<uint64_t>   imageValues;    // Timeline value of the last frame that rendered to each swapchain image
+    };
+
+    struct FrameStats
+    {
+        double              frameMs;            // Average CPU time between prepareFrame calls
+        double              waitMs;             // Average time the CPU spent blocked on the GPU
+        double              overlap;            // Share of the frame the CPU was not waiting on the GPU
+        uint32_t            framesInFlight;
     };
 
     class VulkanInstance
     {
     protected:
-        void initialise(GLFWwindow *window, VkExtent2D screenExtent);
+        void initialise(GLFWwindow *window, VkExtent2D screenExtent, uint32_t frameCount = 2, std::string_view gpuOverride = {});
         void shutdown();
-        void prepareFrame();
+        bool prepareFrame();
         void submitFrame();
 
+        // Resizes arrive in bursts while dragging a window edge, the swapchain is only
+        // recreated once no new size was reported for ResizeDebounce
+        void notifyResize(VkExtent2D newExtent);
+
+        // Takes effect on the next swapchain recreation
+        void setAttachmentPolicy(const AttachmentPolicy &policy);
+        void setSampleTier(SampleTier tier);
+
+        // Renders the default render pass into an offscreen target at a scale driven by the measured
+        // GPU frame time, then upscales it into the swapchain image with a blit
+        void setDynamicResolution(const DynamicResolution &settings);
+
+        const ResolutionStats &getResolutionStats() const { return resolutionStats; }
+
+        // Applied at the start of the next prepareFrame, which recreates only the swapchain. Attachments
+        // and the render pass are kept. Safe to call while a frame is being recorded.
+        void setPresentConfig(const PresentConfig &config);
+
+        // Call right before sampling input. Blocks until no more than maxQueuedFrames - 1 frames are
+        // still queued on the GPU, so the next frame is built from the freshest input possible.
+        void waitForFrameLatency();
+
+        const PresentConfig &getPresentConfig() const { return presentConfig; }
+        const PresentStats &getPresentStats() const { return presentStats; }
+
+        const AttachmentStats &getAttachmentStats() const { return attachmentStats; }
+        const FrameStats &getFrameStats() const { return frameStats; }
+        VulkanDevice &getDevice() { return device; }
+        uint32_t getFramesInFlight() const { return framesInFlight; }
+        uint32_t getCurrentFrame() const { return currentFrame; }
+        uint32_t getImageIndex() const { return imageIndex; }
+        VkFramebuffer getFramebuffer() const { return framebuffers[imageIndex]; }
+        VkRenderPass getRenderPass() const { return renderPass; }
+        VkSampleCountFlagBits getSampleCount() const { return sampleCount; }
+        VkExtent2D getExtent() const { return renderExtent; }
+        VkExtent2D getSwapchainExtent() const { return extent; }
+        VkImage getSwapchainImage() const { return swapchainImages[imageIndex]; }
+        VkImageView getSwapchainView() const { return swapchainViews[imageIndex]; }
+        VkFormat getSurfaceFormat() const { return surfaceFormat.format; }
+        VkFormat getDepthFormat() const { return depth.format; }
+
+        // Single sampled image the default render pass leaves its result in, the swapchain image or the
+        // offscreen target of dynamic resolution, and the layout it is left in
+        VkImage getTargetImage() const { return upscaling ? scaled.image : swapchainImages[imageIndex]; }
+        VkImageView getTargetView() const { return upscaling ? scaled.view : swapchainViews[imageIndex]; }
+        VkImageLayout getTargetLayout() const
+        {
+            return upscaling ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        }
+
         void setVsync(bool value)
         {
-            vSync = value;
-            windowResize();
+            auto config = presentConfigPending ? pendingPresentConfig : presentConfig;
+            config.mode = value ? PresentMode::Vsync : PresentMode::LowLatency;
+            setPresentConfig(config);
         }
 
+        // Called by prepareFrame to record commandBuffers[getCurrentFrame()] for getFramebuffer().
+        // The buffer was reset and its previous submission has completed. Attachments may be larger
+        // than what is rendered to, render area, viewport and scissor must use getExtent(). Attachment 0
+        // is the colour target, 1 the depth buffer, clear values for a resolve target are ignored.
+        // Call gpuProfiler.beginFrame() first thing after vkBeginCommandBuffer to time regions,
+        // and passQueries.beginFrame() to collect pipeline statistics per pass.
+        // Passes declared in renderGraph are recorded by renderGraph.execute() after the default pass, bind
+        // getTargetImage() to its imported resource first. The graph is invalidated whenever the swapchain
+        // is recreated.
+        // Compute work the frame depends on is recorded into asyncCompute.begin(getCurrentFrame()) and
+        // submitted from here as well, the frame's graphics submission waits on it or, without a compute
+        // queue of its own, carries the command buffer itself.
         virtual void buildCommandBuffers() = 0;
 
+        // Called whenever the default render pass was created, during initialise and again when the
+        // surface format or sample tier change. Pipelines built for the previous pass may no longer match.
+        virtual void renderPassChanged() {}
+
         VkCommandBuffer	            commandBuffers[MAX_IMAGES_IN_FLIGHT];
+        DescriptorLayoutCache       descriptorLayouts;
+        DescriptorAllocator         descriptorAllocator;    // Per-frame sets, recycled after each submitFrame()
+        GpuProfiler                 gpuProfiler;
+        PassQueries                 passQueries;
+        AsyncCompute                asyncCompute;
+        ImageTracker                imageTracker;
+        RenderGraph                 renderGraph;
 
     private:
-        void setupSwapchain();
+        static constexpr auto ResizeDebounce = std::chrono::milliseconds(50);
+
+        // Frames between render scale changes, lets the smoothed GPU time catch up with the last one
+        static constexpr uint32_t ScaleAdjustInterval = 15;
+        static constexpr float ScaleStep = 0.1f;             // Largest relative change per adjustment
+        static constexpr double ScaleUpHeadroom = 1.15;     // Budget left over before scaling back up
+
+        static VkSampleCountFlagBits tierSamples(SampleTier tier);
+
+        void selectSurfaceFormat();
+        bool setupSwapchain();
+        VkExtent2D attachmentCapacity(VkExtent2D target) const;
+        void updateAttachmentStats();
+        bool canUpscale() const;
+        VkExtent2D maxRenderExtent() const;
         void setupMsaa();
         void setupDepth();
+        void setupScaled();
         void setupRenderPass();
         void setupFramebuffers();
         void setupSyncPrimitives();
-        void windowResize();
+        bool recreateSwapchain();
+        void retireAttachment(FramebufferAttachment &attachment);
+        void updateFrameStats(double waitMs);
+        void updateRenderScale();
+        void recordPrologue();
+        void recordEpilogue();
+        void collectLatency();
 
         VkInstance					instance;
         VkSurfaceKHR				surface;
@@ -61,16 +250,60 @@ namespace vks
         VkSampleCountFlagBits       sampleCount;
         VkRenderPass                renderPass;
         VkExtent2D					extent;
+        VkExtent2D                  requestedExtent;
         std::vector<VkFramebuffer>	framebuffers;
         std::vector<VkImageView>	swapchainViews;
         std::vector<VkImage>		swapchainImages;
 
-        FramebufferAttachment       msaa, depth;
+        FramebufferAttachment       msaa, depth, scaled;
+        VkExtent2D                  attachmentExtent;
+        AttachmentPolicy            attachmentPolicy;
+        AttachmentStats             attachmentStats;
+        SampleTier                  sampleTier;
+        bool                        targetsDirty;       // Sample count or upscaling changed, rebuild the render pass
         SyncObjects                 sync;
 
+        DynamicResolution           resolution;
+        ResolutionStats             resolutionStats;
+        VkExtent2D                  renderExtent;
+        VkFilter                    upscaleFilter;
+        VkImageUsageFlags           swapchainUsage;
+        bool                        upscaling;
+        uint32_t                    framesSinceScaleChange;
+
+        // Timestamps around every frame's submission, whatever the application profiles
+        VkQueryPool                 frameTimer;
+        bool                        frameTimerWritten[MAX_IMAGES_IN_FLIGHT];
+        VkCommandBuffer             prologueCommands[MAX_IMAGES_IN_FLIGHT];
+        VkCommandBuffer             epilogueCommands[MAX_IMAGES_IN_FLIGHT];
+
         uint32_t					imageCount;
+        uint32_t                    framesInFlight;
         uint32_t		            currentFrame;
         uint32_t		            imageIndex;
-        bool                        vSync;
+        bool                        resizePending;
+        std::chrono::steady_clock::time_point   lastResizeEvent;
+
+        FrameStats                  frameStats;
+        std::chrono::steady_clock::time_point   lastFrameStart;
+        double                      accumulatedFrameMs;
+        double                      accumulatedWaitMs;
+        uint32_t                    accumulatedFrames;
+
+        struct LatencySample
+        {
+            uint64_t                                frameValue;
+            std::chrono::steady_clock::time_point   inputTime;
+            PresentMode                             mode;
+        };
+
+        PresentConfig               presentConfig;
+        PresentConfig               pendingPresentConfig;
+        bool                        presentConfigPending;
+        PresentStats                presentStats;
+        std::deque<LatencySample>   latencySamples;
+        std::chrono::steady_clock::time_point   inputTime;
+        bool                        inputSampled;
+        double                      latencyWaitMs;      // Spent in waitForFrameLatency, counted in the next frame's wait
     };
 } // vks
@@ -0,0 +1,92 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#include "VulkanMemory.hpp"
+
+namespace vks
+{
+    void MemoryBudget::initialise(VkPhysicalDevice gpu,
+                                  const VkPhysicalDeviceMemoryProperties &props,
+                                  PFN_vkGetPhysicalDeviceMemoryProperties2KHR getMemoryProperties2)
+    {
+        physicalDevice = gpu;
+        memProps = props;
+        getProperties2 = getMemoryProperties2;
+
+        for (uint32_t i = 0; i < memProps.memoryHeapCount; i++)
+        {
+            heaps[i].size = memProps.memoryHeaps[i].size;
+            heaps[i].budget = heaps[i].size * FallbackBudgetPercent / 100;
+            heaps[i].usage = 0;
+            heaps[i].allocated = 0;
+            allocatedAtUpdate[i] = 0;
+        }
+
+        update();
+    }
+
+    void MemoryBudget::update()
+    {
+        if (getProperties2 == nullptr)
+            return;
+
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProps{};
+        budgetProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+        VkPhysicalDeviceMemoryProperties2KHR props2{};
+        props2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2_KHR;
+        props2.pNext = &budgetProps;
+        getProperties2(physicalDevice, &props2);
+
+        std::lock_guard lock(mutex);
+
+        for (uint32_t i = 0; i < memProps.memoryHeapCount; i++)
+        {
+            heaps[i].budget = budgetProps.heapBudget[i];
+            heaps[i].usage = budgetProps.heapUsage[i];
+            allocatedAtUpdate[i] = heaps[i].allocated;
+        }
+    }
+
+    void MemoryBudget::onAllocate(uint32_t typeIndex, VkDeviceSize size)
+    {
+        const auto heapIndex = memProps.memoryTypes[typeIndex].heapIndex;
+
+        std::lock_guard lock(mutex);
+        heaps[heapIndex].allocated += size;
+    }
+
+    void MemoryBudget::onFree(uint32_t typeIndex, VkDeviceSize size)
+    {
+        const auto heapIndex = memProps.memoryTypes[typeIndex].heapIndex;
+
+        std::lock_guard lock(mutex);
+        heaps[heapIndex].allocated -= min(size, heaps[heapIndex].allocated);
+    }
+
+    bool MemoryBudget::fits(uint32_t typeIndex, VkDeviceSize size) const
+    {
+        const auto heap = getHeap(memProps.memoryTypes[typeIndex].heapIndex);
+        return heap.usage + size <= heap.budget;
+    }
+
+    HeapBudget MemoryBudget::getHeap(uint32_t heapIndex) const
+    {
+        std::lock_guard lock(mutex);
+        auto heap = heaps[heapIndex];
+
+        // Driver usage is only as fresh as the last update, account for what we allocated since then
+        if (getProperties2 != nullptr)
+        {
+            const auto delta = int64_t(heap.allocated) - int64_t(allocatedAtUpdate[heapIndex]);
+            heap.usage = VkDeviceSize(max(int64_t(heap.usage) + delta, int64_t(0)));
+        }
+        else
+        {
+            heap.usage = heap.allocated;
+        }
+
+        return heap;
+    }
+} // vks
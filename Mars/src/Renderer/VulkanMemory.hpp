@@ -0,0 +1,55 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#pragma once
+
+#include "Base/VulkanInitialisers.hpp"
+
+#include <mutex>
+
+namespace vks
+{
+    constexpr uint32_t INVALID_MEMORY_TYPE = UINT32_MAX;
+
+    struct HeapBudget
+    {
+        VkDeviceSize size;
+        VkDeviceSize budget;
+        VkDeviceSize usage;
+        VkDeviceSize allocated;  // Bytes allocated through this tracker only
+    };
+
+    // Tracks usage and budget per memory heap. Uses VK_EXT_memory_budget when available,
+    // otherwise the budget is a fixed share of the heap size and usage is our own counters.
+    class MemoryBudget
+    {
+        // Share of a heap we allow ourselves when the driver cannot tell us the real budget
+        static constexpr VkDeviceSize FallbackBudgetPercent = 80;
+
+    public:
+        void initialise(VkPhysicalDevice gpu,
+                        const VkPhysicalDeviceMemoryProperties &props,
+                        PFN_vkGetPhysicalDeviceMemoryProperties2KHR getMemoryProperties2);
+
+        // Re-queries the driver budget, cheap enough to call once per frame
+        void update();
+
+        void onAllocate(uint32_t typeIndex, VkDeviceSize size);
+        void onFree(uint32_t typeIndex, VkDeviceSize size);
+
+        bool fits(uint32_t typeIndex, VkDeviceSize size) const;
+        HeapBudget getHeap(uint32_t heapIndex) const;
+
+        uint32_t heapCount() const { return memProps.memoryHeapCount; }
+        bool driverBudget() const { return getProperties2 != nullptr; }
+
+    private:
+        VkPhysicalDevice                            physicalDevice;
+        VkPhysicalDeviceMemoryProperties            memProps;
+        PFN_vkGetPhysicalDeviceMemoryProperties2KHR getProperties2;
+        HeapBudget                                  heaps[VK_MAX_MEMORY_HEAPS];
+        VkDeviceSize                                allocatedAtUpdate[VK_MAX_MEMORY_HEAPS];
+        mutable std::mutex                          mutex;
+    };
+} // vks
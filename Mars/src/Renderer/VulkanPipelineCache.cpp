@@ -0,0 +1,389 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#include "VulkanPipelineCache.hpp"
+
+#include <filesystem>
+#include <fstream>
+
+namespace vks
+{
+    void PipelineCache::initialise(VulkanDevice *dev, Mars::JobSystem *jobSystem)
+    {
+        device = dev;
+        jobs = jobSystem;
+        stats = {};
+    }
+
+    void PipelineCache::shutdown()
+    {
+        wait();
+
+        for (auto &[key, entry] : entries)
+        {
+            if (entry.state == State::Ready)
+                vkDestroyPipeline(*device, entry.pipeline, nullptr);
+        }
+
+        entries.clear();
+        shaders.clear();
+        renderPasses.clear();
+        layouts.clear();
+    }
+
+    void PipelineCache::registerShader(uint64_t id, VkShaderModule module)
+    {
+        std::lock_guard lock(mutex);
+        shaders[id] = module;
+    }
+
+    void PipelineCache::registerRenderPass(uint64_t id, VkRenderPass renderPass)
+    {
+        std::lock_guard lock(mutex);
+        renderPasses[id] = renderPass;
+    }
+
+    void PipelineCache::registerLayout(uint64_t id, VkPipelineLayout layout)
+    {
+        std::lock_guard lock(mutex);
+        layouts[id] = layout;
+    }
+
+    VkPipeline PipelineCache::request(const PipelineDesc &desc, VkPipeline fallback)
+    {
+        bool inserted = false;
+        auto &entry = findOrQueue(desc, inserted);
+
+        if (inserted)
+            jobs->submit([this, &entry]{ build(entry); });
+
+        if (entry.state == State::Ready)
+            return entry.pipeline;
+
+        if (entry.state == State::Pending)
+        {
+            std::lock_guard lock(mutex);
+            stats.hitchesAvoided++;
+        }
+
+        return fallback;
+    }
+
+    VkPipeline PipelineCache::compile(const PipelineDesc &desc)
+    {
+        bool inserted = false;
+        auto &entry = findOrQueue(desc, inserted);
+
+        if (inserted)
+        {
+            build(entry);
+        }
+        else
+        {
+            std::unique_lock lock(mutex);
+            built.wait(lock, [&entry]{ return entry.state != State::Pending; });
+        }
+
+        return entry.state == State::Ready ? entry.pipeline : VK_NULL_HANDLE;
+    }
+
+    bool PipelineCache::isReady(const PipelineDesc &desc)
+    {
+        std::lock_guard lock(mutex);
+
+        const auto entry = find(desc, desc.hash());
+        return entry != nullptr && entry->state == State::Ready;
+    }
+
+    bool PipelineCache::saveManifest(const char *path)
+    {
+        auto descs = std::vector<PipelineDesc>();
+        {
+            std::lock_guard lock(mutex);
+
+            for (auto &[key, entry] : entries)
+            {
+                if (entry.used)
+                    descs.push_back(entry.desc);
+            }
+        }
+
+        ManifestHeader header{};
+        header.magic = ManifestMagic;
+        header.version = ManifestVersion;
+        header.descSize = sizeof(PipelineDesc);
+        header.count = uint32_t(descs.size());
+
+        const auto tempPath = std::string(path) + ".tmp";
+        {
+            auto file = std::ofstream(tempPath, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(descs.data()), std::streamsize(descs.size() * sizeof(PipelineDesc)));
+
+            if (!file)
+            {
+                std::cout << "Warning, could not write pipeline manifest " << tempPath << std::endl;
+                return false;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(tempPath, path, error);
+
+        if (error)
+        {
+            std::cout << "Warning, could not replace pipeline manifest: " << error.message() << std::endl;
+            std::filesystem::remove(tempPath, error);
+            return false;
+        }
+
+        return true;
+    }
+
+    uint32_t PipelineCache::precompile(const char *path)
+    {
+        auto file = std::ifstream(path, std::ios::binary);
+
+        ManifestHeader header{};
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+        // A changed PipelineDesc layout makes every stored key meaningless, start over
+        if (!file || header.magic != ManifestMagic || header.version != ManifestVersion ||
+            header.descSize != sizeof(PipelineDesc))
+        {
+            if (file.gcount() > 0)
+                std::cout << "Discarding incompatible pipeline manifest " << path << std::endl;
+
+            return 0;
+        }
+
+        auto descs = std::vector<PipelineDesc>(header.count);
+        file.read(reinterpret_cast<char*>(descs.data()), std::streamsize(descs.size() * sizeof(PipelineDesc)));
+        descs.resize(size_t(file.gcount()) / sizeof(PipelineDesc));
+
+        {
+            std::lock_guard lock(mutex);
+            stats.precompileQueued = 0;
+            stats.precompileDone = 0;
+            stats.precompileMs = 0.0;
+            precompileStart = std::chrono::steady_clock::now();
+        }
+
+        auto queued = std::vector<Entry*>();
+
+        for (const auto &desc : descs)
+        {
+            bool inserted = false;
+            auto &entry = findOrQueue(desc, inserted, false);
+
+            if (inserted)
+                queued.push_back(&entry);
+        }
+
+        // Counted up front so a fast worker cannot report completion while we are still queueing
+        {
+            std::lock_guard lock(mutex);
+
+            for (auto entry : queued)
+                entry->precompiled = true;
+
+            stats.precompileQueued = uint32_t(queued.size());
+        }
+
+        for (auto entry : queued)
+            jobs->submit([this, entry]{ build(*entry); });
+
+        std::cout << "Precompiling " << queued.size() << " pipelines from " << path
+                  << " on " << jobs->workerCount() << " workers" << std::endl;
+
+        return uint32_t(queued.size());
+    }
+
+    float PipelineCache::precompileProgress()
+    {
+        std::lock_guard lock(mutex);
+
+        if (stats.precompileQueued == 0)
+            return 1.0f;
+
+        return float(stats.precompileDone) / float(stats.precompileQueued);
+    }
+
+    void PipelineCache::wait()
+    {
+        std::unique_lock lock(mutex);
+        built.wait(lock, [this]{ return stats.pending == 0; });
+    }
+
+    PipelineCache::Stats PipelineCache::getStats()
+    {
+        std::lock_guard lock(mutex);
+        return stats;
+    }
+
+    PipelineCache::Entry &PipelineCache::findOrQueue(const PipelineDesc &desc, bool &inserted, bool use)
+    {
+        std::lock_guard lock(mutex);
+
+        const auto key = desc.hash();
+        auto existing = find(desc, key);
+        inserted = existing == nullptr;
+
+        // Map nodes never move, so workers can hold on to the entry without the lock
+        if (inserted)
+            existing = &entries.emplace(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple())->second;
+
+        auto &entry = *existing;
+
+        if (inserted)
+        {
+            entry.desc = desc;
+            entry.pipeline = VK_NULL_HANDLE;
+            entry.state = State::Pending;
+            entry.used = false;
+            entry.precompiled = false;
+            stats.requested++;
+            stats.pending++;
+        }
+
+        if (use)
+            entry.used = true;
+
+        return entry;
+    }
+
+    PipelineCache::Entry *PipelineCache::find(const PipelineDesc &desc, uint64_t key)
+    {
+        const auto [first, last] = entries.equal_range(key);
+
+        for (auto it = first; it != last; ++it)
+        {
+            if (it->second.desc == desc)
+                return &it->second;
+        }
+
+        return nullptr;
+    }
+
+    void PipelineCache::build(Entry &entry)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        const auto pipeline = createPipeline(entry.desc);
+        const auto compileMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        {
+            std::lock_guard lock(mutex);
+
+            entry.pipeline = pipeline;
+            entry.state = pipeline != VK_NULL_HANDLE ? State::Ready : State::Failed;
+
+            if (pipeline != VK_NULL_HANDLE)
+                stats.compiled++;
+            else
+                stats.failed++;
+
+            stats.pending--;
+            stats.compileMs += compileMs;
+            stats.maxCompileMs = max(stats.maxCompileMs, compileMs);
+
+            if (entry.precompiled && ++stats.precompileDone == stats.precompileQueued)
+            {
+                stats.precompileMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - precompileStart).count();
+                std::cout << "Precompiled " << stats.precompileQueued << " pipelines in " << stats.precompileMs << " ms" << std::endl;
+            }
+        }
+
+        built.notify_all();
+    }
+
+    VkPipeline PipelineCache::createPipeline(const PipelineDesc &desc)
+    {
+        VkPipelineShaderStageCreateInfo stages[PipelineDesc::MaxStages];
+        VkRenderPass renderPass = VK_NULL_HANDLE;
+        VkPipelineLayout layout = VK_NULL_HANDLE;
+        {
+            std::lock_guard lock(mutex);
+
+            for (uint32_t i = 0; i < desc.stageCount; i++)
+            {
+                const auto it = shaders.find(desc.shaders[i]);
+                stages[i] = Inits::shaderStageInfo(desc.stages[i], it != shaders.end() ? it->second : VK_NULL_HANDLE);
+            }
+
+            const auto passIt = renderPasses.find(desc.renderPass);
+            renderPass = passIt != renderPasses.end() ? passIt->second : VK_NULL_HANDLE;
+
+            const auto layoutIt = layouts.find(desc.layout);
+            layout = layoutIt != layouts.end() ? layoutIt->second : VK_NULL_HANDLE;
+        }
+
+        for (uint32_t i = 0; i < desc.stageCount; i++)
+        {
+            if (stages[i].module == VK_NULL_HANDLE)
+                renderPass = VK_NULL_HANDLE;
+        }
+
+        if (renderPass == VK_NULL_HANDLE || layout == VK_NULL_HANDLE)
+        {
+            std::cout << "Error, pipeline " << std::hex << desc.hash() << std::dec
+                      << " references an unregistered shader, render pass or layout" << std::endl;
+            return VK_NULL_HANDLE;
+        }
+
+        const auto binding = Inits::vertexBindingDescription(desc.vertexStride);
+
+        VkPipelineVertexInputStateCreateInfo vertexInput{};
+        vertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+        vertexInput.vertexBindingDescriptionCount = desc.vertexStride > 0 ? 1 : 0;
+        vertexInput.pVertexBindingDescriptions = &binding;
+        vertexInput.vertexAttributeDescriptionCount = desc.attributeCount;
+        vertexInput.pVertexAttributeDescriptions = desc.attributes;
+
+        auto inputAssembly = Inits::inputAssemblyInfo();
+        inputAssembly.topology = desc.topology;
+        inputAssembly.primitiveRestartEnable = desc.primitiveRestart;
+
+        const auto viewportState = Inits::pipelineViewportStateCreateInfo(1, 1);
+
+        auto rasterizer = Inits::rasterizationStateInfo(desc.frontFace);
+        rasterizer.polygonMode = desc.polygonMode;
+        rasterizer.cullMode = desc.cullMode;
+
+        const auto multisampling = Inits::pipelineMultisampleStateCreateInfo(desc.samples);
+
+        auto depthStencil = Inits::depthStencilStateInfo();
+        depthStencil.depthTestEnable = desc.depthTest;
+        depthStencil.depthWriteEnable = desc.depthWrite;
+        depthStencil.depthCompareOp = desc.depthCompare;
+
+        auto colourBlend = Inits::pipelineColorBlendStateCreateInfo(desc.blend);
+        colourBlend.attachmentCount = desc.colourAttachmentCount;
+
+        const VkDynamicState dynamicStates[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+        const auto dynamicState = Inits::pipelineDynamicStateCreateInfo(dynamicStates);
+
+        VkGraphicsPipelineCreateInfo pipelineInfo{};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+        pipelineInfo.stageCount = desc.stageCount;
+        pipelineInfo.pStages = stages;
+        pipelineInfo.pVertexInputState = &vertexInput;
+        pipelineInfo.pInputAssemblyState = &inputAssembly;
+        pipelineInfo.pViewportState = &viewportState;
+        pipelineInfo.pRasterizationState = &rasterizer;
+        pipelineInfo.pMultisampleState = &multisampling;
+        pipelineInfo.pDepthStencilState = &depthStencil;
+        pipelineInfo.pColorBlendState = &colourBlend;
+        pipelineInfo.pDynamicState = &dynamicState;
+        pipelineInfo.layout = layout;
+        pipelineInfo.renderPass = renderPass;
+        pipelineInfo.subpass = desc.subpass;
+
+        VkPipeline pipeline = VK_NULL_HANDLE;
+
+        if (device->createGraphicsPipeline(pipelineInfo, &pipeline) != VK_SUCCESS)
+            return VK_NULL_HANDLE;
+
+        return pipeline;
+    }
+} // vks
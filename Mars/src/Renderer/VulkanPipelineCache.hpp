@@ -0,0 +1,184 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#pragma once
+
+#include "VulkanDevice.hpp"
+#include "../Core/JobSystem.hpp"
+#include "../Utilities/hash_utils.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <type_traits>
+
+namespace vks
+{
+    // Full graphics pipeline state in a flat, padding-free layout so it can be hashed and written to disk.
+    // Shaders, render passes and layouts are referenced by stable ids registered with the PipelineCache.
+    // The attachment formats and sample count are part of the state, a pass registered again under the
+    // same id after its formats changed gets new pipelines instead of ones built for the old pass.
+    // Viewport and scissor are always dynamic.
+    struct PipelineDesc
+    {
+        static constexpr uint32_t MaxStages = 2;
+        static constexpr uint32_t MaxAttributes = 8;
+        static constexpr uint32_t MaxColourAttachments = 4;
+
+        uint64_t                            shaders[MaxStages]{};
+        uint64_t                            renderPass = 0;
+        uint64_t                            layout = 0;
+        VkShaderStageFlagBits               stages[MaxStages]{};
+        uint32_t                            stageCount = 0;
+        uint32_t                            subpass = 0;
+        uint32_t                            vertexStride = 0;
+        uint32_t                            attributeCount = 0;
+        VkVertexInputAttributeDescription   attributes[MaxAttributes]{};
+        VkPrimitiveTopology                 topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        VkBool32                            primitiveRestart = VK_FALSE;
+        VkPolygonMode                       polygonMode = VK_POLYGON_MODE_FILL;
+        VkCullModeFlags                     cullMode = VK_CULL_MODE_BACK_BIT;
+        VkFrontFace                         frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+        VkSampleCountFlagBits               samples = VK_SAMPLE_COUNT_1_BIT;
+        VkBool32                            depthTest = VK_TRUE;
+        VkBool32                            depthWrite = VK_TRUE;
+        VkCompareOp                         depthCompare = VK_COMPARE_OP_LESS;
+        uint32_t                            colourAttachmentCount = 1;
+        VkFormat                            colourFormats[MaxColourAttachments]{};
+        VkFormat                            depthFormat = VK_FORMAT_UNDEFINED;
+        uint32_t                            reserved = 0;       // Explicit, implicit tail padding is not hashable
+        VkPipelineColorBlendAttachmentState blend[MaxColourAttachments]{
+            Inits::pipelineColorBlendAttachmentState(), Inits::pipelineColorBlendAttachmentState(),
+            Inits::pipelineColorBlendAttachmentState(), Inits::pipelineColorBlendAttachmentState()
+        };
+
+        void addStage(VkShaderStageFlagBits stage, uint64_t shader)
+        {
+            stages[stageCount] = stage;
+            shaders[stageCount] = shader;
+            stageCount++;
+        }
+
+        void addAttribute(uint32_t location, VkFormat format, uint32_t offset)
+        {
+            attributes[attributeCount++] = { location, 0, format, offset };
+        }
+
+        // Single colour attachment targets such as the default render pass
+        void setTarget(VkFormat colour, VkFormat depth, VkSampleCountFlagBits sampleCount)
+        {
+            colourFormats[0] = colour;
+            depthFormat = depth;
+            samples = sampleCount;
+        }
+
+        uint64_t hash() const
+        {
+            return HashBytes(this, sizeof(*this));
+        }
+
+        bool operator==(const PipelineDesc &other) const
+        {
+            return std::memcmp(this, &other, sizeof(*this)) == 0;
+        }
+    };
+
+    static_assert(std::has_unique_object_representations_v<PipelineDesc>,
+                  "PipelineDesc must not contain padding, its bytes are hashed and compared");
+
+    // Deduplicates graphics pipelines by state and compiles them on worker threads. The state hash only
+    // narrows the lookup, entries are matched on the full PipelineDesc so colliding states stay apart.
+    // request() never blocks: until a pipeline is ready it returns the caller's fallback,
+    // or VK_NULL_HANDLE meaning the draw should be skipped this frame.
+    class PipelineCache
+    {
+        enum class State : uint32_t
+        {
+            Pending,
+            Ready,
+            Failed
+        };
+
+        struct Entry
+        {
+            PipelineDesc        desc;
+            VkPipeline          pipeline;
+            std::atomic<State>  state;
+            std::atomic<bool>   used;           // Requested by the session, written to the manifest
+            bool                precompiled;
+        };
+
+        struct ManifestHeader
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t descSize;
+            uint32_t count;
+        };
+
+        static constexpr uint32_t ManifestMagic = 0x4D50534D; // "MSPM"
+        static constexpr uint32_t ManifestVersion = 2;
+
+    public:
+        struct Stats
+        {
+            uint32_t    requested;
+            uint32_t    compiled;
+            uint32_t    failed;
+            uint32_t    pending;
+            uint32_t    hitchesAvoided;     // Requests answered with a fallback instead of compiling inline
+            double      compileMs;
+            double      maxCompileMs;
+            uint32_t    precompileQueued;   // Entries queued by the last precompile() call
+            uint32_t    precompileDone;
+            double      precompileMs;       // Wall time of the last precompile, once it finished
+        };
+
+        void initialise(VulkanDevice *dev, Mars::JobSystem *jobSystem);
+        void shutdown();
+
+        void registerShader(uint64_t id, VkShaderModule module);
+        void registerRenderPass(uint64_t id, VkRenderPass renderPass);
+        void registerLayout(uint64_t id, VkPipelineLayout layout);
+
+        VkPipeline request(const PipelineDesc &desc, VkPipeline fallback = VK_NULL_HANDLE);
+
+        // Blocking variant for loading screens, joins an in-flight compile of the same state
+        VkPipeline compile(const PipelineDesc &desc);
+
+        bool isReady(const PipelineDesc &desc);
+
+        // Writes every pipeline state requested this session, replacing the file atomically
+        bool saveManifest(const char *path);
+
+        // Queues a manifest from a previous session across all workers, returns the number queued.
+        // Shaders, render passes and layouts it references must be registered first.
+        uint32_t precompile(const char *path);
+
+        // 0 to 1 for loading screens, 1 when no precompile is running
+        float precompileProgress();
+
+        // Blocks until every queued compile has finished
+        void wait();
+
+        Stats getStats();
+
+    private:
+        Entry &findOrQueue(const PipelineDesc &desc, bool &inserted, bool use = true);
+        Entry *find(const PipelineDesc &desc, uint64_t key);
+        void build(Entry &entry);
+        VkPipeline createPipeline(const PipelineDesc &desc);
+
+        VulkanDevice                                        *device;
+        Mars::JobSystem                                     *jobs;
+        std::unordered_multimap<uint64_t, Entry>            entries;        // By PipelineDesc::hash()
+        std::unordered_map<uint64_t, VkShaderModule>        shaders;
+        std::unordered_map<uint64_t, VkRenderPass>          renderPasses;
+        std::unordered_map<uint64_t, VkPipelineLayout>      layouts;
+        std::mutex                                          mutex;
+        std::condition_variable                             built;
+        Stats                                               stats;
+        std::chrono::steady_clock::time_point               precompileStart;
+    };
+} // vks
@@ -0,0 +1,221 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#include "VulkanProfiler.hpp"
+
+#include <cstring>
+#include <fstream>
+
+namespace vks
+{
+    void GpuProfiler::initialise(VulkanDevice *dev, uint32_t maxRegions)
+    {
+        device = dev;
+        frameIndex = 0;
+        depth = 0;
+        recording = false;
+        capturing = false;
+        captureOrigin = 0;
+        maxQueries = maxRegions * 2;
+        timestampMask = 0;
+
+        uint32_t familyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(device->gpu, &familyCount, nullptr);
+        auto families = std::vector<VkQueueFamilyProperties>(familyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(device->gpu, &familyCount, families.data());
+
+        const auto validBits = families[device->indices.graphics].timestampValidBits;
+
+        if (validBits == 0)
+        {
+            std::cout << "GPU profiler disabled, the graphics queue does not support timestamps" << std::endl;
+            return;
+        }
+
+        timestampMask = validBits >= 64 ? UINT64_MAX : (uint64_t(1) << validBits) - 1;
+
+        // Nanoseconds per tick
+        msPerTick = double(device->gpuProperties.limits.timestampPeriod) / 1e6;
+
+        VkQueryPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        poolInfo.queryCount = maxQueries;
+
+        for (auto &frame : frames)
+        {
+            vkCreateQueryPool(*device, &poolInfo, nullptr, &frame.pool);
+            frame.regions.reserve(maxRegions);
+            frame.queryCount = 0;
+            frame.pending = false;
+        }
+
+        timestamps.resize(maxQueries);
+    }
+
+    void GpuProfiler::shutdown()
+    {
+        if (!supported())
+            return;
+
+        for (auto &frame : frames)
+            vkDestroyQueryPool(*device, frame.pool, nullptr);
+
+        timestampMask = 0;
+    }
+
+    void GpuProfiler::beginFrame(VkCommandBuffer command)
+    {
+        recording = false;
+
+        if (!supported())
+            return;
+
+        auto &frame = frames[frameIndex];
+
+        if (frame.pending)
+            resolve(frame);
+
+        // Still in flight after Latency frames, skip profiling this frame rather than wait
+        if (frame.pending)
+            return;
+
+        vkCmdResetQueryPool(command, frame.pool, 0, maxQueries);
+        frame.regions.clear();
+        frame.queryCount = 0;
+        depth = 0;
+        recording = true;
+    }
+
+    uint32_t GpuProfiler::begin(VkCommandBuffer command, const char *name)
+    {
+        auto &frame = frames[frameIndex];
+
+        if (!recording || frame.queryCount + 2 > maxQueries)
+            return UINT32_MAX;
+
+        const auto region = uint32_t(frame.regions.size());
+        frame.regions.push_back({ name, depth++, frame.queryCount, frame.queryCount + 1 });
+        frame.queryCount += 2;
+
+        vkCmdWriteTimestamp(command, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.pool, frame.regions[region].beginQuery);
+        return region;
+    }
+
+    void GpuProfiler::end(VkCommandBuffer command, uint32_t region)
+    {
+        if (!recording || region == UINT32_MAX)
+            return;
+
+        auto &frame = frames[frameIndex];
+        depth--;
+        vkCmdWriteTimestamp(command, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame.pool, frame.regions[region].endQuery);
+    }
+
+    void GpuProfiler::endFrame(SubmitToken frameToken)
+    {
+        if (!recording)
+            return;
+
+        auto &frame = frames[frameIndex];
+        frame.token = frameToken;
+        frame.pending = frame.queryCount > 0;
+        recording = false;
+
+        frameIndex = (frameIndex + 1) % Latency;
+    }
+
+    double GpuProfiler::getRegionMs(const char *name) const
+    {
+        double total = 0.0;
+
+        for (const auto &region : results)
+        {
+            if (std::strcmp(region.name, name) == 0)
+                total += region.durationMs;
+        }
+
+        return total;
+    }
+
+    void GpuProfiler::beginCapture()
+    {
+        captured.clear();
+        captureOrigin = 0;
+        capturing = true;
+    }
+
+    bool GpuProfiler::exportChromeTrace(const char *path)
+    {
+        capturing = false;
+
+        auto file = std::ofstream(path, std::ios::trunc);
+
+        if (!file)
+        {
+            std::cout << "Error, could not write GPU trace " << path << std::endl;
+            return false;
+        }
+
+        // Trace event format, durations in microseconds, one track per nesting level
+        file << "{\"traceEvents\":[\n";
+
+        for (size_t i = 0; i < captured.size(); i++)
+        {
+            const auto &entry = captured[i];
+            file << "{\"name\":\"" << entry.region.name << "\",\"cat\":\"gpu\",\"ph\":\"X\",\"pid\":0,\"tid\":"
+                 << entry.region.depth << ",\"ts\":" << (entry.frameStartMs + entry.region.startMs) * 1000.0
+                 << ",\"dur\":" << entry.region.durationMs * 1000.0 << "}"
+                 << (i + 1 < captured.size() ? ",\n" : "\n");
+        }
+
+        file << "],\"displayTimeUnit\":\"ms\"}\n";
+        captured.clear();
+        return bool(file);
+    }
+
+    void GpuProfiler::resolve(FrameQueries &frame)
+    {
+        if (!frame.token.timeline->isComplete(frame.token.value))
+            return;
+
+        const auto result = vkGetQueryPoolResults(*device, frame.pool, 0, frame.queryCount,
+                                                  frame.queryCount * sizeof(uint64_t), timestamps.data(),
+                                                  sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+
+        // Should not happen once the frame's value has completed, try again next time around
+        if (result == VK_NOT_READY)
+            return;
+
+        frame.pending = false;
+        results.clear();
+
+        if (result != VK_SUCCESS)
+            return;
+
+        const auto origin = timestamps[0] & timestampMask;
+
+        for (const auto &region : frame.regions)
+        {
+            const auto begin = timestamps[region.beginQuery] & timestampMask;
+            const auto end = timestamps[region.endQuery] & timestampMask;
+
+            // Masked counters can wrap between two queries
+            const auto ticks = (end - begin) & timestampMask;
+            const auto offset = (begin - origin) & timestampMask;
+            results.push_back({ region.name, double(offset) * msPerTick, double(ticks) * msPerTick, region.depth });
+        }
+
+        if (!capturing)
+            return;
+
+        if (captured.empty())
+            captureOrigin = origin;
+
+        const auto frameStartMs = double((origin - captureOrigin) & timestampMask) * msPerTick;
+
+        for (const auto &region : results)
+            captured.push_back({ region, frameStartMs });
+    }
+} // vks
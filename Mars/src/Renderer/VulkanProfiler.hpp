@@ -0,0 +1,117 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#pragma once
+
+#include "VulkanDevice.hpp"
+
+namespace vks
+{
+    struct GpuRegion
+    {
+        const char  *name;
+        double      startMs;        // Relative to the first timestamp of its frame
+        double      durationMs;
+        uint32_t    depth;          // Nesting level of the region
+    };
+
+    // Timestamp queries around named regions of the frame's command buffer. Every frame writes into its
+    // own query pool and results are read back Latency frames later without waiting, so profiling never
+    // stalls the CPU. Devices or queues without timestamp support turn every call into a no-op.
+    class GpuProfiler
+    {
+        static constexpr uint32_t Latency = MAX_IMAGES_IN_FLIGHT + 1;
+
+        struct Region
+        {
+            const char  *name;
+            uint32_t    depth;
+            uint32_t    beginQuery;
+            uint32_t    endQuery;
+        };
+
+        struct FrameQueries
+        {
+            VkQueryPool             pool;
+            std::vector<Region>     regions;
+            uint32_t                queryCount;
+            SubmitToken             token;
+            bool                    pending;
+        };
+
+    public:
+        void initialise(VulkanDevice *dev, uint32_t maxRegions = 128);
+        void shutdown();
+
+        // Must be the first command recorded, outside of any render pass
+        void beginFrame(VkCommandBuffer command);
+
+        // Region names must outlive the profiler, string literals are expected
+        uint32_t begin(VkCommandBuffer command, const char *name);
+        void end(VkCommandBuffer command, uint32_t region);
+
+        // Marks the recorded frame as submitted, with the token its graphics submission returned
+        void endFrame(SubmitToken frameToken);
+
+        bool supported() const { return timestampMask != 0; }
+
+        // For timestamps written outside of profiled regions
+        double ticksToMs(uint64_t begin, uint64_t end) const
+        {
+            return double((end - begin) & timestampMask) * msPerTick;
+        }
+
+        // Most recent frame whose results are available
+        const std::vector<GpuRegion> &getResults() const { return results; }
+        double getRegionMs(const char *name) const;
+
+        // Collects every resolved frame until exportChromeTrace writes them out
+        void beginCapture();
+        bool exportChromeTrace(const char *path);
+
+    private:
+        void resolve(FrameQueries &frame);
+
+        struct CapturedRegion
+        {
+            GpuRegion   region;
+            double      frameStartMs;
+        };
+
+        VulkanDevice                    *device;
+        FrameQueries                    frames[Latency];
+        uint32_t                        frameIndex;
+        uint32_t                        depth;
+        uint32_t                        maxQueries;
+        uint64_t                        timestampMask;
+        double                          msPerTick;
+        bool                            recording;
+        std::vector<GpuRegion>          results;
+        std::vector<uint64_t>           timestamps;
+
+        bool                            capturing;
+        std::vector<CapturedRegion>     captured;
+        uint64_t                        captureOrigin;
+    };
+
+    // Times a scope of a command buffer
+    class GpuScope
+    {
+    public:
+        GpuScope(GpuProfiler &gpuProfiler, VkCommandBuffer command, const char *name)
+            : profiler(gpuProfiler), cmd(command), region(gpuProfiler.begin(command, name))
+        {
+        }
+
+        ~GpuScope()
+        {
+            profiler.end(cmd, region);
+        }
+
+    private:
+        GpuProfiler         &profiler;
+        VkCommandBuffer     cmd;
+        uint32_t            region;
+    };
+} // vks
@@ -0,0 +1,186 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#include "VulkanQueries.hpp"
+
+#include <cstring>
+
+namespace vks
+{
+    void PassQueries::initialise(VulkanDevice *dev, uint32_t maxPassCount)
+    {
+        device = dev;
+        maxPasses = maxPassCount;
+        frameIndex = 0;
+        recording = false;
+        statistics = device->enabledFeatures.pipelineStatisticsQuery;
+        precise = device->enabledFeatures.occlusionQueryPrecise;
+
+        if (!statistics)
+            std::cout << "Pipeline statistics queries unsupported, only occlusion is reported" << std::endl;
+
+        VkQueryPoolCreateInfo statisticsInfo{};
+        statisticsInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        statisticsInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+        statisticsInfo.queryCount = maxPasses;
+        statisticsInfo.pipelineStatistics = StatisticFlags;
+
+        VkQueryPoolCreateInfo occlusionInfo{};
+        occlusionInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        occlusionInfo.queryType = VK_QUERY_TYPE_OCCLUSION;
+        occlusionInfo.queryCount = maxPasses;
+
+        for (auto &frame : frames)
+        {
+            frame.statisticsPool = VK_NULL_HANDLE;
+
+            if (statistics)
+                vkCreateQueryPool(*device, &statisticsInfo, nullptr, &frame.statisticsPool);
+
+            vkCreateQueryPool(*device, &occlusionInfo, nullptr, &frame.occlusionPool);
+            frame.passes.reserve(maxPasses);
+            frame.pending = false;
+        }
+
+        readback.resize(maxPasses * StatisticCount);
+    }
+
+    void PassQueries::shutdown()
+    {
+        for (auto &frame : frames)
+        {
+            if (frame.statisticsPool != VK_NULL_HANDLE)
+                vkDestroyQueryPool(*device, frame.statisticsPool, nullptr);
+
+            vkDestroyQueryPool(*device, frame.occlusionPool, nullptr);
+        }
+    }
+
+    void PassQueries::beginFrame(VkCommandBuffer command)
+    {
+        recording = false;
+        auto &frame = frames[frameIndex];
+
+        if (frame.pending)
+            resolve(frame);
+
+        // Skip a frame rather than wait on results that are still in flight
+        if (frame.pending)
+            return;
+
+        if (statistics)
+            vkCmdResetQueryPool(command, frame.statisticsPool, 0, maxPasses);
+
+        vkCmdResetQueryPool(command, frame.occlusionPool, 0, maxPasses);
+        frame.passes.clear();
+        recording = true;
+    }
+
+    uint32_t PassQueries::beginPass(VkCommandBuffer command, const char *name, bool occlusion)
+    {
+        auto &frame = frames[frameIndex];
+
+        if (!recording || frame.passes.size() == maxPasses)
+            return UINT32_MAX;
+
+        const auto pass = uint32_t(frame.passes.size());
+        frame.passes.push_back({ name, occlusion });
+
+        if (statistics)
+            vkCmdBeginQuery(command, frame.statisticsPool, pass, 0);
+
+        if (occlusion)
+            vkCmdBeginQuery(command, frame.occlusionPool, pass, precise ? VK_QUERY_CONTROL_PRECISE_BIT : 0);
+
+        return pass;
+    }
+
+    void PassQueries::endPass(VkCommandBuffer command, uint32_t pass)
+    {
+        if (!recording || pass == UINT32_MAX)
+            return;
+
+        auto &frame = frames[frameIndex];
+
+        if (frame.passes[pass].occlusion)
+            vkCmdEndQuery(command, frame.occlusionPool, pass);
+
+        if (statistics)
+            vkCmdEndQuery(command, frame.statisticsPool, pass);
+    }
+
+    void PassQueries::endFrame(SubmitToken frameToken)
+    {
+        if (!recording)
+            return;
+
+        auto &frame = frames[frameIndex];
+        frame.token = frameToken;
+        frame.pending = !frame.passes.empty();
+        recording = false;
+
+        frameIndex = (frameIndex + 1) % Latency;
+    }
+
+    const PassStats *PassQueries::getPass(const char *name) const
+    {
+        for (const auto &pass : results)
+        {
+            if (std::strcmp(pass.name, name) == 0)
+                return &pass;
+        }
+
+        return nullptr;
+    }
+
+    void PassQueries::resolve(FrameQueries &frame)
+    {
+        if (!frame.token.timeline->isComplete(frame.token.value))
+            return;
+
+        const auto passCount = uint32_t(frame.passes.size());
+        auto stats = std::vector<PassStats>(passCount);
+
+        for (uint32_t i = 0; i < passCount; i++)
+            stats[i].name = frame.passes[i].name;
+
+        if (statistics)
+        {
+            constexpr auto Stride = StatisticCount * sizeof(uint64_t);
+            const auto result = vkGetQueryPoolResults(*device, frame.statisticsPool, 0, passCount,
+                                                      passCount * Stride, readback.data(), Stride,
+                                                      VK_QUERY_RESULT_64_BIT);
+            if (result == VK_NOT_READY)
+                return;
+
+            for (uint32_t i = 0; i < passCount && result == VK_SUCCESS; i++)
+            {
+                const auto values = &readback[i * StatisticCount];
+                stats[i].inputVertices = values[0];
+                stats[i].vertexInvocations = values[1];
+                stats[i].clippingInvocations = values[2];
+                stats[i].clippingPrimitives = values[3];
+                stats[i].fragmentInvocations = values[4];
+            }
+        }
+
+        // Passes without occlusion never began their query, so read them one at a time
+        for (uint32_t i = 0; i < passCount; i++)
+        {
+            if (!frame.passes[i].occlusion)
+                continue;
+
+            uint64_t samples = 0;
+            const auto result = vkGetQueryPoolResults(*device, frame.occlusionPool, i, 1, sizeof(samples),
+                                                      &samples, sizeof(samples), VK_QUERY_RESULT_64_BIT);
+            if (result == VK_NOT_READY)
+                return;
+
+            stats[i].samplesPassed = samples;
+        }
+
+        frame.pending = false;
+        results = std::move(stats);
+    }
+} // vks
@@ -0,0 +1,94 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#pragma once
+
+#include "VulkanDevice.hpp"
+
+namespace vks
+{
+    struct PassStats
+    {
+        const char  *name;
+        uint64_t    inputVertices;
+        uint64_t    vertexInvocations;
+        uint64_t    clippingInvocations;    // Primitives reaching the clipper
+        uint64_t    clippingPrimitives;     // Primitives leaving it
+        uint64_t    fragmentInvocations;
+        uint64_t    samplesPassed;          // Occlusion query, zero when only statistics were requested
+
+        // Fragments shaded per sample that survived depth, well above 1 points at overdraw
+        double overdraw() const
+        {
+            return samplesPassed > 0 ? double(fragmentInvocations) / double(samplesPassed) : 0.0;
+        }
+    };
+
+    // Pipeline statistics and occlusion queries per pass, one pool pair per frame in the ring and read back
+    // without waiting, like GpuProfiler. Statistics need the pipelineStatisticsQuery feature, which
+    // VulkanDevice enables when present; without it only occlusion results are reported.
+    class PassQueries
+    {
+        static constexpr uint32_t Latency = MAX_IMAGES_IN_FLIGHT + 1;
+
+        // Results come back in bit order of the enabled flags
+        static constexpr VkQueryPipelineStatisticFlags StatisticFlags =
+                VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |
+                VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+                VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
+                VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+                VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+
+        static constexpr uint32_t StatisticCount = 5;
+
+        struct Pass
+        {
+            const char  *name;
+            bool        occlusion;
+        };
+
+        struct FrameQueries
+        {
+            VkQueryPool         statisticsPool;
+            VkQueryPool         occlusionPool;
+            std::vector<Pass>   passes;
+            SubmitToken         token;
+            bool                pending;
+        };
+
+    public:
+        void initialise(VulkanDevice *dev, uint32_t maxPassCount = 32);
+        void shutdown();
+
+        // Must be recorded outside of any render pass, before the first query
+        void beginFrame(VkCommandBuffer command);
+
+        // Begin and end must be in the same subpass, or both outside of a render pass.
+        // Pass names must outlive the queries, string literals are expected.
+        uint32_t beginPass(VkCommandBuffer command, const char *name, bool occlusion = true);
+        void endPass(VkCommandBuffer command, uint32_t pass);
+
+        // Marks the recorded frame as submitted, with the token its graphics submission returned
+        void endFrame(SubmitToken frameToken);
+
+        bool statisticsSupported() const { return statistics; }
+
+        // Most recent frame whose results are available
+        const std::vector<PassStats> &getResults() const { return results; }
+        const PassStats *getPass(const char *name) const;
+
+    private:
+        void resolve(FrameQueries &frame);
+
+        VulkanDevice                *device;
+        FrameQueries                frames[Latency];
+        uint32_t                    frameIndex;
+        uint32_t                    maxPasses;
+        bool                        statistics;
+        bool                        precise;
+        bool                        recording;
+        std::vector<PassStats>      results;
+        std::vector<uint64_t>       readback;
+    };
+} // vks
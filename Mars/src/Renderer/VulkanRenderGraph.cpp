@@ -0,0 +1,736 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#include "VulkanRenderGraph.hpp"
+
+#include <algorithm>
+
+namespace vks
+{
+    constexpr VkImageUsageFlags AttachmentUsageMask = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                                                      VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+
+    void RGPassBuilder::colour(RGResource resource, VkAttachmentLoadOp loadOp, VkClearColorValue clear)
+    {
+        if (graph->passes[pass].colours.size() == RenderGraph::MaxColourAttachments)
+        {
+            std::cout << "Warning, too many colour attachments in pass " << graph->passes[pass].name << std::endl;
+            return;
+        }
+
+        VkClearValue value{};
+        value.color = clear;
+        graph->passes[pass].colours.push_back({ resource, loadOp, VK_ATTACHMENT_STORE_OP_STORE, value });
+        graph->addUse(pass, resource, RGAccess::ColourAttachment, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                      loadOp == VK_ATTACHMENT_LOAD_OP_LOAD, true);
+    }
+
+    void RGPassBuilder::depth(RGResource resource, VkAttachmentLoadOp loadOp, VkClearDepthStencilValue clear)
+    {
+        VkClearValue value{};
+        value.depthStencil = clear;
+        graph->passes[pass].depth = { resource, loadOp, VK_ATTACHMENT_STORE_OP_STORE, value };
+        graph->addUse(pass, resource, RGAccess::DepthAttachment, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+                      loadOp == VK_ATTACHMENT_LOAD_OP_LOAD, true);
+    }
+
+    void RGPassBuilder::resolve(RGResource resource)
+    {
+        VkClearValue value{};
+        graph->passes[pass].resolves.push_back({ resource, VK_ATTACHMENT_LOAD_OP_DONT_CARE, VK_ATTACHMENT_STORE_OP_STORE, value });
+        graph->addUse(pass, resource, RGAccess::ResolveTarget, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, false, true);
+    }
+
+    void RGPassBuilder::read(RGResource resource, RGAccess access, VkPipelineStageFlags stage)
+    {
+        graph->addUse(pass, resource, access, stage, true, false);
+    }
+
+    void RGPassBuilder::write(RGResource resource, RGAccess access, VkPipelineStageFlags stage)
+    {
+        graph->addUse(pass, resource, access, stage, false, true);
+    }
+
+    void RGPassBuilder::sideEffects()
+    {
+        graph->passes[pass].sideEffects = true;
+    }
+
+    void RenderGraph::initialise(VulkanDevice *dev, ImageTracker *imageTracker, VkExtent2D graphExtent)
+    {
+        device = dev;
+        tracker = imageTracker;
+        extent = graphExtent;
+        stats = {};
+        dirty = true;
+    }
+
+    void RenderGraph::shutdown()
+    {
+        releaseCompiled();
+        passes.clear();
+        resources.clear();
+    }
+
+    void RenderGraph::reset()
+    {
+        releaseCompiled();
+        passes.clear();
+        resources.clear();
+        dirty = true;
+    }
+
+    RGResource RenderGraph::createImage(const char *name, const RGImageDesc &desc)
+    {
+        Resource resource{};
+        resource.name = name;
+        resource.desc = desc;
+        resource.imported = false;
+        resource.output = false;
+        resources.push_back(resource);
+
+        dirty = true;
+        return RGResource(resources.size() - 1);
+    }
+
+    RGResource RenderGraph::importImage(const char *name,
+                                        VkFormat format,
+                                        VkExtent2D imageExtent,
+                                        VkImageLayout initialLayout,
+                                        VkImageLayout finalLayout,
+                                        VkPipelineStageFlags initialStage)
+    {
+        Resource resource{};
+        resource.name = name;
+        resource.desc = { format, VK_SAMPLE_COUNT_1_BIT, imageExtent };
+        resource.imported = true;
+        resource.output = true;
+        resource.initial = { initialLayout, 0, initialStage };
+        resource.finalLayout = finalLayout;
+        resources.push_back(resource);
+
+        dirty = true;
+        return RGResource(resources.size() - 1);
+    }
+
+    void RenderGraph::bindImage(RGResource resource, VkImage image, VkImageView view)
+    {
+        resources[resource].image = image;
+        resources[resource].view = view;
+
+        if (image != VK_NULL_HANDLE && !tracker->isTracked(image))
+            tracker->track(image, aspectMask(resources[resource].desc.format));
+    }
+
+    void RenderGraph::setOutput(RGResource resource)
+    {
+        resources[resource].output = true;
+        dirty = true;
+    }
+
+    uint32_t RenderGraph::addGraphicsPass(const char *name,
+                                          const std::function<void(RGPassBuilder&)> &setup,
+                                          RGExecuteFn execute)
+    {
+        return addPass(name, true, setup, std::move(execute));
+    }
+
+    uint32_t RenderGraph::addComputePass(const char *name,
+                                         const std::function<void(RGPassBuilder&)> &setup,
+                                         RGExecuteFn execute)
+    {
+        return addPass(name, false, setup, std::move(execute));
+    }
+
+    void RenderGraph::setExtent(VkExtent2D graphExtent)
+    {
+        if (graphExtent.width == extent.width && graphExtent.height == extent.height)
+            return;
+
+        extent = graphExtent;
+        dirty = true;
+    }
+
+    void RenderGraph::compile()
+    {
+        releaseCompiled();
+
+        for (auto &resource : resources)
+        {
+            const auto &desc = resource.desc;
+            resource.extent = (desc.extent.width == 0 || desc.extent.height == 0) ? extent : desc.extent;
+        }
+
+        cullPasses();
+        computeLifetimes();
+        allocateTransients();
+
+        stats.passes = uint32_t(passes.size());
+        stats.culledPasses = 0;
+        stats.renderPasses = 0;
+
+        for (auto &pass : passes)
+        {
+            if (pass.culled)
+            {
+                stats.culledPasses++;
+                continue;
+            }
+
+            if (pass.graphics)
+            {
+                createRenderPass(pass);
+                stats.renderPasses++;
+            }
+            else
+            {
+                pass.extent = extent;
+            }
+        }
+
+        stats.compiles++;
+        dirty = false;
+    }
+
+    void RenderGraph::execute(VkCommandBuffer command)
+    {
+        if (dirty)
+            compile();
+
+        for (auto &resource : resources)
+        {
+            resource.touched = false;
+
+            if (resource.imported && resource.image != VK_NULL_HANDLE)
+                tracker->setState(resource.image, resource.initial);
+        }
+
+        std::vector<VkClearValue> clearValues;
+
+        for (uint32_t i = 0; i < uint32_t(passes.size()); i++)
+        {
+            auto &pass = passes[i];
+
+            if (pass.culled)
+                continue;
+
+            for (const auto &use : pass.uses)
+                require(use.resource, accessState(use.access, use.stage), resources[use.resource].lastPass == i);
+
+            // One barrier call per pass, however many images it touches
+            tracker->flush(command);
+
+            RGPassContext context{ command, pass.renderPass, pass.extent, this };
+
+            if (!pass.graphics)
+            {
+                pass.execute(context);
+                continue;
+            }
+
+            clearValues.clear();
+
+            for (const auto &attachment : pass.colours)
+                clearValues.push_back(attachment.clear);
+
+            if (pass.depth.resource != RG_INVALID_RESOURCE)
+                clearValues.push_back(pass.depth.clear);
+
+            auto beginInfo = Inits::renderPassBeginInfo(pass.renderPass, pass.extent);
+            beginInfo.framebuffer = getFramebuffer(pass);
+            beginInfo.clearValueCount = uint32_t(clearValues.size());
+            beginInfo.pClearValues = clearValues.data();
+            vkCmdBeginRenderPass(command, &beginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+            const auto viewport = Inits::viewportInfo(pass.extent);
+            const auto scissor = Inits::scissorInfo(pass.extent);
+            vkCmdSetViewport(command, 0, 1, &viewport);
+            vkCmdSetScissor(command, 0, 1, &scissor);
+
+            pass.execute(context);
+
+            vkCmdEndRenderPass(command);
+        }
+
+        for (RGResource i = 0; i < RGResource(resources.size()); i++)
+        {
+            const auto &resource = resources[i];
+
+            // All commands rather than bottom of pipe, so barriers recorded after the graph chain onto the transition
+            if (resource.imported && resource.finalLayout != VK_IMAGE_LAYOUT_UNDEFINED)
+                require(i, { resource.finalLayout, 0, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT }, false);
+        }
+
+        tracker->flush(command);
+    }
+
+    uint32_t RenderGraph::addPass(const char *name,
+                                  bool graphics,
+                                  const std::function<void(RGPassBuilder&)> &setup,
+                                  RGExecuteFn execute)
+    {
+        const auto index = uint32_t(passes.size());
+
+        auto &pass = passes.emplace_back();
+        pass.name = name;
+        pass.graphics = graphics;
+        pass.sideEffects = false;
+        pass.culled = false;
+        pass.execute = std::move(execute);
+        pass.depth.resource = RG_INVALID_RESOURCE;
+        pass.renderPass = VK_NULL_HANDLE;
+
+        RGPassBuilder builder(this, index);
+        setup(builder);
+
+        dirty = true;
+        return index;
+    }
+
+    void RenderGraph::addUse(uint32_t pass, RGResource resource, RGAccess access, VkPipelineStageFlags stage,
+                             bool reads, bool writes)
+    {
+        passes[pass].uses.push_back({ resource, access, stage, reads, writes });
+    }
+
+    void RenderGraph::cullPasses()
+    {
+        // Walks the passes backwards, a pass survives if a later pass or an output needs what it writes
+        std::vector<bool> needed(resources.size());
+
+        for (size_t i = 0; i < resources.size(); i++)
+            needed[i] = resources[i].output;
+
+        for (auto pass = passes.rbegin(); pass != passes.rend(); ++pass)
+        {
+            bool contributes = pass->sideEffects;
+
+            for (const auto &use : pass->uses)
+                contributes = contributes || (use.writes && needed[use.resource]);
+
+            pass->culled = !contributes;
+
+            if (pass->culled)
+                continue;
+
+            // Contents nobody reads afterwards never have to leave tile memory
+            const auto storeOp = [&](RGResource resource) {
+                return needed[resource] ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            };
+
+            for (auto &attachment : pass->colours)
+                attachment.storeOp = storeOp(attachment.resource);
+
+            for (auto &attachment : pass->resolves)
+                attachment.storeOp = storeOp(attachment.resource);
+
+            if (pass->depth.resource != RG_INVALID_RESOURCE)
+                pass->depth.storeOp = storeOp(pass->depth.resource);
+
+            // Overwritten contents are not needed from earlier passes, read contents are
+            for (const auto &use : pass->uses)
+            {
+                if (use.writes && !use.reads)
+                    needed[use.resource] = false;
+            }
+
+            for (const auto &use : pass->uses)
+            {
+                if (use.reads)
+                    needed[use.resource] = true;
+            }
+        }
+    }
+
+    void RenderGraph::computeLifetimes()
+    {
+        for (auto &resource : resources)
+        {
+            resource.firstPass = UINT32_MAX;
+            resource.lastPass = 0;
+            resource.usage = 0;
+        }
+
+        for (uint32_t i = 0; i < uint32_t(passes.size()); i++)
+        {
+            if (passes[i].culled)
+                continue;
+
+            for (const auto &use : passes[i].uses)
+            {
+                auto &resource = resources[use.resource];
+                resource.firstPass = min(resource.firstPass, i);
+                resource.lastPass = max(resource.lastPass, i);
+                resource.usage |= accessUsage(use.access);
+            }
+        }
+
+        // Attachments living within a single pass can stay in tile memory, unless code outside the graph reads them
+        for (auto &resource : resources)
+        {
+            if (!resource.imported && !resource.output && resource.firstPass == resource.lastPass &&
+                (resource.usage & ~AttachmentUsageMask) == 0)
+                resource.usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+        }
+    }
+
+    void RenderGraph::allocateTransients()
+    {
+        std::vector<VkMemoryRequirements> memReqs(resources.size());
+        std::vector<uint32_t> order;
+
+        stats.transientImages = 0;
+        stats.requestedBytes = 0;
+
+        for (uint32_t i = 0; i < uint32_t(resources.size()); i++)
+        {
+            auto &resource = resources[i];
+
+            if (resource.imported || resource.firstPass == UINT32_MAX)
+                continue;
+
+            auto imageInfo = Inits::imageCreateInfo();
+            imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            imageInfo.extent = { resource.extent.width, resource.extent.height, 1 };
+            imageInfo.samples = resource.desc.samples;
+            imageInfo.format = resource.desc.format;
+            imageInfo.usage = resource.usage;
+            vkCreateImage(*device, &imageInfo, nullptr, &resource.image);
+
+            vkGetImageMemoryRequirements(*device, resource.image, &memReqs[i]);
+            resource.size = memReqs[i].size;
+
+            order.push_back(i);
+            stats.transientImages++;
+            stats.requestedBytes += resource.size;
+        }
+
+        // Largest first, so every block is sized by its first resident and later ones fit at offset zero
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return resources[a].size > resources[b].size;
+        });
+
+        const auto overlaps = [&](const Resource &a, const Resource &b) {
+            return a.firstPass <= b.lastPass && b.firstPass <= a.lastPass;
+        };
+
+        for (const auto index : order)
+        {
+            auto &resource = resources[index];
+            const bool lazy = (resource.usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT) != 0;
+
+            resource.block = UINT32_MAX;
+
+            for (uint32_t b = 0; b < uint32_t(blocks.size()) && resource.block == UINT32_MAX; b++)
+            {
+                auto &block = blocks[b];
+
+                if (block.lazy != lazy || block.size < resource.size || (block.typeBits & memReqs[index].memoryTypeBits) == 0)
+                    continue;
+
+                bool free = true;
+
+                for (const auto resident : block.residents)
+                    free = free && !overlaps(resource, resources[resident]);
+
+                if (free)
+                    resource.block = b;
+            }
+
+            if (resource.block == UINT32_MAX)
+            {
+                resource.block = uint32_t(blocks.size());
+
+                auto &block = blocks.emplace_back();
+                block.memory = VK_NULL_HANDLE;
+                block.size = resource.size;
+                block.typeBits = memReqs[index].memoryTypeBits;
+                block.lazy = lazy;
+                block.lastUse = { VK_IMAGE_LAYOUT_UNDEFINED, 0, 0 };
+            }
+
+            auto &block = blocks[resource.block];
+            block.typeBits &= memReqs[index].memoryTypeBits;
+            block.residents.push_back(index);
+        }
+
+        stats.memoryBlocks = uint32_t(blocks.size());
+        stats.allocatedBytes = 0;
+
+        for (auto &block : blocks)
+        {
+            VkMemoryRequirements blockReqs{};
+            blockReqs.size = block.size;
+            blockReqs.alignment = 1;
+            blockReqs.memoryTypeBits = block.typeBits;
+
+            const VkMemoryPropertyFlags preferred = block.lazy ? VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT : 0;
+            auto allocInfo = device->getMemoryAllocInfo(blockReqs, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, preferred);
+            device->allocateMemory(allocInfo, &block.memory);
+            stats.allocatedBytes += block.size;
+
+            for (const auto index : block.residents)
+            {
+                auto &resource = resources[index];
+                vkBindImageMemory(*device, resource.image, block.memory, 0);
+                tracker->track(resource.image, aspectMask(resource.desc.format));
+
+                auto viewInfo = Inits::imageViewCreateInfo();
+                viewInfo.image = resource.image;
+                viewInfo.format = resource.desc.format;
+                viewInfo.subresourceRange.aspectMask = aspectMask(resource.desc.format);
+
+                // Depth-stencil views are sampled as depth
+                if (viewInfo.subresourceRange.aspectMask & VK_IMAGE_ASPECT_DEPTH_BIT)
+                    viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+
+                vkCreateImageView(*device, &viewInfo, nullptr, &resource.view);
+            }
+        }
+
+        stats.savedBytes = stats.requestedBytes - min(stats.allocatedBytes, stats.requestedBytes);
+    }
+
+    void RenderGraph::createRenderPass(Pass &pass)
+    {
+        std::vector<VkAttachmentDescription> attachments;
+        std::vector<VkAttachmentReference> colourRefs;
+        std::vector<VkAttachmentReference> resolveRefs;
+        VkAttachmentReference depthRef{};
+
+        const auto addAttachment = [&](const Attachment &attachment, VkImageLayout layout) {
+            const auto &resource = resources[attachment.resource];
+
+            auto description = Inits::attachmentDescription(resource.desc.format);
+            description.samples = resource.desc.samples;
+            description.loadOp = attachment.loadOp;
+            description.storeOp = attachment.storeOp;
+            description.initialLayout = layout;
+            description.finalLayout = layout;
+            attachments.push_back(description);
+
+            auto reference = Inits::attachmentReference(uint32_t(attachments.size() - 1));
+            reference.layout = layout;
+            return reference;
+        };
+
+        // Layout transitions happen in the graph's barriers, attachments stay in one layout throughout
+        for (const auto &attachment : pass.colours)
+            colourRefs.push_back(addAttachment(attachment, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL));
+
+        if (pass.depth.resource != RG_INVALID_RESOURCE)
+            depthRef = addAttachment(pass.depth, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+
+        if (!pass.resolves.empty())
+        {
+            resolveRefs.resize(colourRefs.size(), { VK_ATTACHMENT_UNUSED, VK_IMAGE_LAYOUT_UNDEFINED });
+
+            for (size_t i = 0; i < min(pass.resolves.size(), resolveRefs.size()); i++)
+                resolveRefs[i] = addAttachment(pass.resolves[i], VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+        }
+
+        VkSubpassDescription subpass{};
+        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpass.colorAttachmentCount = uint32_t(colourRefs.size());
+        subpass.pColorAttachments = colourRefs.data();
+        subpass.pResolveAttachments = resolveRefs.empty() ? nullptr : resolveRefs.data();
+        subpass.pDepthStencilAttachment = pass.depth.resource != RG_INVALID_RESOURCE ? &depthRef : nullptr;
+
+        VkRenderPassCreateInfo renderPassInfo{};
+        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        renderPassInfo.attachmentCount = uint32_t(attachments.size());
+        renderPassInfo.pAttachments = attachments.data();
+        renderPassInfo.subpassCount = 1;
+        renderPassInfo.pSubpasses = &subpass;
+        vkCreateRenderPass(*device, &renderPassInfo, nullptr, &pass.renderPass);
+
+        const auto first = pass.colours.empty() ? pass.depth.resource : pass.colours.front().resource;
+        pass.extent = first != RG_INVALID_RESOURCE ? resources[first].extent : extent;
+    }
+
+    VkFramebuffer RenderGraph::getFramebuffer(Pass &pass)
+    {
+        VkImageView views[2 * MaxColourAttachments + 1];
+        uint32_t viewCount = 0;
+
+        for (const auto &attachment : pass.colours)
+            views[viewCount++] = resources[attachment.resource].view;
+
+        if (pass.depth.resource != RG_INVALID_RESOURCE)
+            views[viewCount++] = resources[pass.depth.resource].view;
+
+        for (size_t i = 0; i < min(pass.resolves.size(), pass.colours.size()); i++)
+            views[viewCount++] = resources[pass.resolves[i].resource].view;
+
+        // Imported views change from frame to frame, so framebuffers are cached per view combination
+        const auto key = HashBytes(views, viewCount * sizeof(VkImageView));
+        const auto it = pass.framebuffers.find(key);
+
+        if (it != pass.framebuffers.end())
+            return it->second;
+
+        auto framebufferInfo = Inits::framebufferCreateInfo();
+        framebufferInfo.renderPass = pass.renderPass;
+        framebufferInfo.attachmentCount = viewCount;
+        framebufferInfo.pAttachments = views;
+        framebufferInfo.width = pass.extent.width;
+        framebufferInfo.height = pass.extent.height;
+
+        VkFramebuffer framebuffer = VK_NULL_HANDLE;
+        vkCreateFramebuffer(*device, &framebufferInfo, nullptr, &framebuffer);
+        pass.framebuffers.emplace(key, framebuffer);
+        stats.framebuffers++;
+
+        return framebuffer;
+    }
+
+    void RenderGraph::releaseCompiled()
+    {
+        auto &deletionQueue = device->deletionQueue;
+
+        for (auto &pass : passes)
+        {
+            for (const auto &[key, framebuffer] : pass.framebuffers)
+                deletionQueue.push(framebuffer);
+
+            deletionQueue.push(pass.renderPass);
+            pass.framebuffers.clear();
+            pass.renderPass = VK_NULL_HANDLE;
+        }
+
+        for (auto &resource : resources)
+        {
+            if (resource.imported)
+                continue;
+
+            if (resource.image != VK_NULL_HANDLE)
+                tracker->untrack(resource.image);
+
+            deletionQueue.push(resource.view);
+            deletionQueue.push(resource.image);
+            resource.view = VK_NULL_HANDLE;
+            resource.image = VK_NULL_HANDLE;
+        }
+
+        for (const auto &block : blocks)
+            deletionQueue.push(block.memory);
+
+        blocks.clear();
+        stats.framebuffers = 0;
+    }
+
+    void RenderGraph::require(RGResource resource, const ImageState &target, bool lastUse)
+    {
+        auto &image = resources[resource];
+
+        if (image.image == VK_NULL_HANDLE)
+            return;
+
+        if (image.imported)
+        {
+            tracker->require(image.image, target);
+            return;
+        }
+
+        auto &block = blocks[image.block];
+
+        // The first use of an aliased image in a frame discards its contents and
+        // has to wait for whoever used the memory before it
+        if (!image.touched)
+        {
+            tracker->setState(image.image, { VK_IMAGE_LAYOUT_UNDEFINED, block.lastUse.access, block.lastUse.stage });
+            block.lastUse = {};
+            image.touched = true;
+        }
+
+        tracker->require(image.image, target);
+
+        if (lastUse)
+        {
+            block.lastUse.access |= target.access;
+            block.lastUse.stage |= target.stage;
+        }
+    }
+
+    ImageState RenderGraph::accessState(RGAccess access, VkPipelineStageFlags stage)
+    {
+        constexpr VkPipelineStageFlags FragmentTests = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+                                                       VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        switch (access)
+        {
+            case RGAccess::ColourAttachment:
+                return { VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                         VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+            case RGAccess::DepthAttachment:
+                return { VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                         VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                         FragmentTests };
+            case RGAccess::DepthRead:
+                return { VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+                         VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_SHADER_READ_BIT,
+                         FragmentTests | stage };
+            case RGAccess::ResolveTarget:
+                return { VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                         VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+            case RGAccess::Sampled:
+                return { VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_READ_BIT, stage };
+            case RGAccess::StorageRead:
+                return { VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_SHADER_READ_BIT, stage };
+            case RGAccess::StorageWrite:
+                return { VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, stage };
+            case RGAccess::TransferSrc:
+                return { VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT };
+            case RGAccess::TransferDst:
+                return { VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT };
+        }
+
+        return { VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT };
+    }
+
+    VkImageUsageFlags RenderGraph::accessUsage(RGAccess access)
+    {
+        switch (access)
+        {
+            case RGAccess::ColourAttachment:
+            case RGAccess::ResolveTarget:
+                return VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+            case RGAccess::DepthAttachment:
+                return VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+            case RGAccess::DepthRead:
+                return VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+            case RGAccess::Sampled:
+                return VK_IMAGE_USAGE_SAMPLED_BIT;
+            case RGAccess::StorageRead:
+            case RGAccess::StorageWrite:
+                return VK_IMAGE_USAGE_STORAGE_BIT;
+            case RGAccess::TransferSrc:
+                return VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+            case RGAccess::TransferDst:
+                return VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        }
+
+        return 0;
+    }
+
+    VkImageAspectFlags RenderGraph::aspectMask(VkFormat format)
+    {
+        switch (format)
+        {
+            case VK_FORMAT_D16_UNORM:
+            case VK_FORMAT_X8_D24_UNORM_PACK32:
+            case VK_FORMAT_D32_SFLOAT:
+                return VK_IMAGE_ASPECT_DEPTH_BIT;
+            case VK_FORMAT_D16_UNORM_S8_UINT:
+            case VK_FORMAT_D24_UNORM_S8_UINT:
+            case VK_FORMAT_D32_SFLOAT_S8_UINT:
+                return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+            case VK_FORMAT_S8_UINT:
+                return VK_IMAGE_ASPECT_STENCIL_BIT;
+            default:
+                return VK_IMAGE_ASPECT_COLOR_BIT;
+        }
+    }
+} // vks
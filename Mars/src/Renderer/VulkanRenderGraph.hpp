@@ -0,0 +1,258 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#pragma once
+
+#include "VulkanDevice.hpp"
+#include "VulkanBarriers.hpp"
+#include "../Utilities/hash_utils.hpp"
+
+#include <functional>
+
+namespace vks
+{
+    using RGResource = uint32_t;
+
+    constexpr RGResource RG_INVALID_RESOURCE = UINT32_MAX;
+
+    // How a pass touches a resource, decides layout, access and stage of the barrier before it
+    enum class RGAccess
+    {
+        ColourAttachment,
+        DepthAttachment,
+        DepthRead,          // Depth test without writes, also samplable in the same pass
+        ResolveTarget,
+        Sampled,
+        StorageRead,
+        StorageWrite,
+        TransferSrc,
+        TransferDst
+    };
+
+    struct RGImageDesc
+    {
+        VkFormat                format;
+        VkSampleCountFlagBits   samples;
+        VkExtent2D              extent;     // Zero follows the graph extent
+    };
+
+    class RenderGraph;
+
+    struct RGPassContext
+    {
+        VkCommandBuffer     command;
+        VkRenderPass        renderPass;     // Null for compute passes
+        VkExtent2D          extent;
+        RenderGraph         *graph;
+    };
+
+    using RGExecuteFn = std::function<void(const RGPassContext&)>;
+
+    // Declares what a pass reads and writes. Colour attachments resolve into resolve targets in the order
+    // both were declared. Loading an attachment counts as reading its previous contents.
+    class RGPassBuilder
+    {
+    public:
+        RGPassBuilder(RenderGraph *renderGraph, uint32_t passIndex) : graph(renderGraph), pass(passIndex) {}
+
+        void colour(RGResource resource,
+                    VkAttachmentLoadOp loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+                    VkClearColorValue clear = {});
+
+        void depth(RGResource resource,
+                   VkAttachmentLoadOp loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+                   VkClearDepthStencilValue clear = { 1.0f, 0 });
+
+        void resolve(RGResource resource);
+
+        void read(RGResource resource,
+                  RGAccess access = RGAccess::Sampled,
+                  VkPipelineStageFlags stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+        void write(RGResource resource,
+                   RGAccess access = RGAccess::StorageWrite,
+                   VkPipelineStageFlags stage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+        // Keeps the pass even if nothing reads what it writes, e.g. readbacks or queries
+        void sideEffects();
+
+    private:
+        RenderGraph *graph;
+        uint32_t    pass;
+    };
+
+    // Declarative frame graph. Passes declare which virtual images they read and write and are executed
+    // in declaration order. Compiling culls passes that contribute nothing to an output, places transient
+    // images whose lifetimes do not overlap in the same memory, and builds render passes and framebuffers
+    // for graphics passes. Barriers between passes are derived from the declared accesses and recorded
+    // through the ImageTracker, so images shared with code outside the graph stay in a known state.
+    // The graph is declared once and recompiled only when it changes or the extent does.
+    class RenderGraph
+    {
+        friend class RGPassBuilder;
+
+        static constexpr uint32_t MaxColourAttachments = 8;
+
+        struct Use
+        {
+            RGResource              resource;
+            RGAccess                access;
+            VkPipelineStageFlags    stage;
+            bool                    reads;
+            bool                    writes;
+        };
+
+        struct Attachment
+        {
+            RGResource          resource;
+            VkAttachmentLoadOp  loadOp;
+            VkAttachmentStoreOp storeOp;
+            VkClearValue        clear;
+        };
+
+        struct Pass
+        {
+            const char                  *name;
+            bool                        graphics;
+            bool                        sideEffects;
+            bool                        culled;
+            RGExecuteFn                 execute;
+            std::vector<Use>            uses;
+            std::vector<Attachment>     colours;
+            std::vector<Attachment>     resolves;
+            Attachment                  depth;
+            VkRenderPass                renderPass;
+            VkExtent2D                  extent;
+            std::unordered_map<uint64_t, VkFramebuffer>  framebuffers;
+        };
+
+        struct Resource
+        {
+            const char          *name;
+            RGImageDesc         desc;
+            bool                imported;
+            bool                output;
+            VkImage             image;
+            VkImageView         view;
+            VkExtent2D          extent;
+            VkImageUsageFlags   usage;
+            VkDeviceSize        size;
+            uint32_t            firstPass;
+            uint32_t            lastPass;
+            uint32_t            block;
+            ImageState          initial;    // Imported only, state at the start of every frame
+            VkImageLayout       finalLayout;
+            bool                touched;    // Used so far in the frame being recorded
+        };
+
+        // Transient images sharing one allocation, their lifetimes never overlap
+        struct MemoryBlock
+        {
+            VkDeviceMemory          memory;
+            VkDeviceSize            size;
+            uint32_t                typeBits;
+            bool                    lazy;
+            std::vector<uint32_t>   residents;
+            ImageState              lastUse;    // Of the previous resident, the next one waits on it
+        };
+
+    public:
+        struct Stats
+        {
+            uint32_t        passes;
+            uint32_t        culledPasses;
+            uint32_t        transientImages;
+            uint32_t        memoryBlocks;
+            uint32_t        renderPasses;
+            uint32_t        framebuffers;
+            uint32_t        compiles;
+            VkDeviceSize    requestedBytes;     // Transient memory needed without aliasing
+            VkDeviceSize    allocatedBytes;     // Memory actually allocated for them
+            VkDeviceSize    savedBytes;
+        };
+
+        void initialise(VulkanDevice *dev, ImageTracker *imageTracker, VkExtent2D graphExtent);
+        void shutdown();
+
+        // Removes every pass and resource, the graph must be declared again
+        void reset();
+
+        RGResource createImage(const char *name, const RGImageDesc &desc);
+
+        // External images, e.g. the swapchain. Their state at the start of each frame is given here,
+        // a final layout other than undefined is transitioned to after the last pass.
+        RGResource importImage(const char *name,
+                               VkFormat format,
+                               VkExtent2D imageExtent,
+                               VkImageLayout initialLayout,
+                               VkImageLayout finalLayout,
+                               VkPipelineStageFlags initialStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+
+        // Imported handles may change every frame without a recompile
+        void bindImage(RGResource resource, VkImage image, VkImageView view);
+
+        // Passes writing to outputs, and everything they depend on, are never culled.
+        // Imported images are outputs by default.
+        void setOutput(RGResource resource);
+
+        uint32_t addGraphicsPass(const char *name,
+                                 const std::function<void(RGPassBuilder&)> &setup,
+                                 RGExecuteFn execute);
+
+        uint32_t addComputePass(const char *name,
+                                const std::function<void(RGPassBuilder&)> &setup,
+                                RGExecuteFn execute);
+
+        void setExtent(VkExtent2D graphExtent);
+
+        // Forces a recompile, needed when imported views were destroyed (swapchain recreation)
+        void invalidate() { dirty = true; }
+
+        void compile();
+
+        // Records every live pass, compiles first if needed. Must be recorded outside of a render pass.
+        void execute(VkCommandBuffer command);
+
+        VkImage getImage(RGResource resource) const { return resources[resource].image; }
+        VkImageView getView(RGResource resource) const { return resources[resource].view; }
+
+        // Valid after compile, pipelines for the pass must be created against it
+        VkRenderPass getRenderPass(uint32_t pass) const { return passes[pass].renderPass; }
+        bool isCulled(uint32_t pass) const { return passes[pass].culled; }
+
+        // Declared, invalidated or resized since the last compile, render passes change with the next one
+        bool isDirty() const { return dirty; }
+
+        const Stats &getStats() const { return stats; }
+
+    private:
+        uint32_t addPass(const char *name,
+                         bool graphics,
+                         const std::function<void(RGPassBuilder&)> &setup,
+                         RGExecuteFn execute);
+
+        void addUse(uint32_t pass, RGResource resource, RGAccess access, VkPipelineStageFlags stage,
+                    bool reads, bool writes);
+        void cullPasses();
+        void computeLifetimes();
+        void allocateTransients();
+        void createRenderPass(Pass &pass);
+        VkFramebuffer getFramebuffer(Pass &pass);
+        void releaseCompiled();
+        void require(RGResource resource, const ImageState &target, bool lastUse);
+
+        static ImageState accessState(RGAccess access, VkPipelineStageFlags stage);
+        static VkImageUsageFlags accessUsage(RGAccess access);
+        static VkImageAspectFlags aspectMask(VkFormat format);
+
+        VulkanDevice                *device;
+        ImageTracker                *tracker;
+        VkExtent2D                  extent;
+        std::vector<Pass>           passes;
+        std::vector<Resource>       resources;
+        std::vector<MemoryBlock>    blocks;
+        Stats                       stats;
+        bool                        dirty;
+    };
+} // vks
@@ -0,0 +1,191 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#include "VulkanShaderLibrary.hpp"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace vks
+{
+    bool MappedFile::open(const char *path)
+    {
+#if defined(_WIN32)
+        file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            file = nullptr;
+            return false;
+        }
+
+        LARGE_INTEGER fileSize{};
+        GetFileSizeEx(file, &fileSize);
+        size = size_t(fileSize.QuadPart);
+        mapping = size > 0 ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+
+        if (mapping != nullptr)
+            bytes = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+        const int fd = ::open(path, O_RDONLY);
+
+        if (fd < 0)
+            return false;
+
+        struct stat info{};
+        fstat(fd, &info);
+        size = size_t(info.st_size);
+
+        if (size > 0)
+        {
+            auto view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            bytes = view != MAP_FAILED ? static_cast<const uint8_t*>(view) : nullptr;
+        }
+
+        // The mapping keeps the file alive on its own
+        ::close(fd);
+#endif
+        if (bytes == nullptr)
+        {
+            close();
+            return false;
+        }
+
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+#if defined(_WIN32)
+        if (bytes != nullptr)
+            UnmapViewOfFile(bytes);
+
+        if (mapping != nullptr)
+            CloseHandle(mapping);
+
+        if (file != nullptr)
+            CloseHandle(file);
+
+        mapping = nullptr;
+        file = nullptr;
+#else
+        if (bytes != nullptr)
+            munmap(const_cast<uint8_t*>(bytes), size);
+#endif
+        bytes = nullptr;
+        size = 0;
+    }
+
+    bool ShaderLibrary::initialise(VkDevice dev, const char *archivePath)
+    {
+        device = dev;
+        stats = {};
+
+        if (!archive.open(archivePath))
+        {
+            std::cout << "Error, could not map shader archive " << archivePath << std::endl;
+            return false;
+        }
+
+        const auto data = archive.data();
+        ArchiveHeader header{};
+
+        if (data.size() >= sizeof(header))
+            std::memcpy(&header, data.data(), sizeof(header));
+
+        if (header.magic != ArchiveMagic || header.version != ArchiveVersion ||
+            data.size() < sizeof(header) + size_t(header.count) * sizeof(ArchiveEntry))
+        {
+            std::cout << "Error, " << archivePath << " is not a valid shader archive" << std::endl;
+            archive.close();
+            return false;
+        }
+
+        for (uint32_t i = 0; i < header.count; i++)
+        {
+            ArchiveEntry entry{};
+            std::memcpy(&entry, data.data() + sizeof(header) + i * sizeof(ArchiveEntry), sizeof(entry));
+
+            const bool valid = entry.offset % sizeof(uint32_t) == 0 && entry.size % sizeof(uint32_t) == 0 &&
+                               size_t(entry.offset) + entry.size <= data.size();
+
+            if (valid)
+                entries[entry.id] = entry;
+        }
+
+        stats.shaders = uint32_t(entries.size());
+        stats.archiveBytes = data.size();
+        return true;
+    }
+
+    void ShaderLibrary::shutdown()
+    {
+        for (auto &[hash, module] : contentModules)
+            vkDestroyShaderModule(device, module, nullptr);
+
+        contentModules.clear();
+        modules.clear();
+        entries.clear();
+        archive.close();
+    }
+
+    VkShaderModule ShaderLibrary::getModule(uint64_t id)
+    {
+        std::lock_guard lock(mutex);
+
+        if (const auto it = modules.find(id); it != modules.end())
+            return it->second;
+
+        const auto entryIt = entries.find(id);
+
+        if (entryIt == entries.end())
+            return VK_NULL_HANDLE;
+
+        const auto &entry = entryIt->second;
+        auto &module = contentModules[entry.contentHash];
+
+        if (module == VK_NULL_HANDLE)
+        {
+            // The mapping is page aligned and offsets are 4 byte aligned, so the driver reads straight from it
+            const auto code = archive.data().subspan(entry.offset, entry.size);
+            Tools::LoadShader(device, code.data(), code.size(), &module);
+            stats.modules++;
+        }
+        else
+        {
+            stats.deduplicated++;
+        }
+
+        modules[id] = module;
+        return module;
+    }
+
+    void ShaderLibrary::registerAll(PipelineCache &pipelines)
+    {
+        auto ids = std::vector<uint64_t>();
+        {
+            std::lock_guard lock(mutex);
+
+            for (const auto &[id, entry] : entries)
+                ids.push_back(id);
+        }
+
+        for (const auto id : ids)
+            pipelines.registerShader(id, getModule(id));
+    }
+
+    ShaderLibrary::Stats ShaderLibrary::getStats()
+    {
+        std::lock_guard lock(mutex);
+        return stats;
+    }
+} // vks
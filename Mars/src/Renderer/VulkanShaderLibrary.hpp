@@ -0,0 +1,98 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#pragma once
+
+#include "VulkanPipelineCache.hpp"
+
+#include <span>
+
+namespace vks
+{
+    // Read-only file mapping, mmap on POSIX and MapViewOfFile on Windows
+    class MappedFile
+    {
+    public:
+        bool open(const char *path);
+        void close();
+
+        std::span<const uint8_t> data() const { return { bytes, size }; }
+
+    private:
+        const uint8_t   *bytes = nullptr;
+        size_t          size = 0;
+#if defined(_WIN32)
+        void            *file = nullptr;
+        void            *mapping = nullptr;
+#endif
+    };
+
+    // All SPIR-V of the application packed into one archive that is mapped instead of read.
+    // Shaders are addressed by the hash of their source path, which is also the id used in PipelineDesc.
+    // Blobs with identical contents share a single VkShaderModule.
+    class ShaderLibrary
+    {
+        struct ArchiveHeader
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t count;
+            uint32_t reserved;
+        };
+
+        struct ArchiveEntry
+        {
+            uint64_t id;
+            uint64_t contentHash;
+            uint32_t offset;            // From the start of the file, 4 byte aligned as SPIR-V requires
+            uint32_t size;
+        };
+
+        static constexpr uint32_t ArchiveMagic = 0x4D535041; // "MSPA"
+        static constexpr uint32_t ArchiveVersion = 1;
+
+    public:
+        struct Stats
+        {
+            uint32_t    shaders;
+            uint32_t    modules;            // Unique modules created so far
+            uint32_t    deduplicated;       // Lookups answered by another shader's identical module
+            size_t      archiveBytes;
+        };
+
+        static uint64_t shaderId(std::string_view name)
+        {
+            return HashBytes(name.data(), name.size());
+        }
+
+        // Build step, packs the given SPIR-V files and stores identical blobs once. Ids hash the paths as
+        // given, tools/ShaderPacker passes file names so shaders are looked up as e.g. "sprite.vert.spv".
+        static bool pack(const char *archivePath, const std::vector<std::string> &files);
+
+        bool initialise(VkDevice dev, const char *archivePath);
+        void shutdown();
+
+        // Creates the module on first use, VK_NULL_HANDLE for unknown ids
+        VkShaderModule getModule(uint64_t id);
+
+        VkShaderModule getModule(std::string_view name)
+        {
+            return getModule(shaderId(name));
+        }
+
+        // Creates every module and hands the id table to the pipeline builder
+        void registerAll(PipelineCache &pipelines);
+
+        Stats getStats();
+
+    private:
+        VkDevice                                        device;
+        MappedFile                                      archive;
+        std::unordered_map<uint64_t, ArchiveEntry>      entries;
+        std::unordered_map<uint64_t, VkShaderModule>    modules;            // By shader id
+        std::unordered_map<uint64_t, VkShaderModule>    contentModules;     // By content hash
+        std::mutex                                      mutex;
+        Stats                                           stats;
+    };
+} // vks
@@ -0,0 +1,92 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#include "VulkanShaderLibrary.hpp"
+
+#include <filesystem>
+#include <fstream>
+
+// Kept apart from the rest of ShaderLibrary so the build step links without the renderer
+
+namespace vks
+{
+    bool ShaderLibrary::pack(const char *archivePath, const std::vector<std::string> &files)
+    {
+        auto table = std::vector<ArchiveEntry>();
+        auto blobs = std::vector<uint8_t>();
+        auto offsets = std::unordered_map<uint64_t, ArchiveEntry>();
+
+        const auto dataStart = uint32_t(sizeof(ArchiveHeader) + files.size() * sizeof(ArchiveEntry));
+
+        for (const auto &path : files)
+        {
+            auto file = std::ifstream(path, std::ios::binary | std::ios::ate);
+
+            if (!file)
+            {
+                std::cout << "Error, could not open shader " << path << std::endl;
+                return false;
+            }
+
+            auto code = std::vector<uint8_t>(size_t(file.tellg()));
+            file.seekg(0);
+            file.read(reinterpret_cast<char*>(code.data()), std::streamsize(code.size()));
+
+            if (code.empty() || code.size() % sizeof(uint32_t) != 0)
+            {
+                std::cout << "Error, " << path << " is not SPIR-V" << std::endl;
+                return false;
+            }
+
+            ArchiveEntry entry{};
+            entry.id = shaderId(path);
+            entry.contentHash = HashBytes(code.data(), code.size());
+            entry.size = uint32_t(code.size());
+
+            const auto [it, inserted] = offsets.try_emplace(entry.contentHash, entry);
+
+            if (inserted)
+            {
+                it->second.offset = dataStart + uint32_t(blobs.size());
+                blobs.insert(blobs.end(), code.begin(), code.end());
+            }
+
+            entry.offset = it->second.offset;
+            table.push_back(entry);
+        }
+
+        ArchiveHeader header{};
+        header.magic = ArchiveMagic;
+        header.version = ArchiveVersion;
+        header.count = uint32_t(table.size());
+
+        const auto tempPath = std::string(archivePath) + ".tmp";
+        {
+            auto file = std::ofstream(tempPath, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(table.data()), std::streamsize(table.size() * sizeof(ArchiveEntry)));
+            file.write(reinterpret_cast<const char*>(blobs.data()), std::streamsize(blobs.size()));
+
+            if (!file)
+            {
+                std::cout << "Error, could not write shader archive " << tempPath << std::endl;
+                return false;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(tempPath, archivePath, error);
+
+        if (error)
+        {
+            std::cout << "Error, could not replace shader archive: " << error.message() << std::endl;
+            return false;
+        }
+
+        std::cout << "Packed " << files.size() << " shaders, " << offsets.size() << " unique, into "
+                  << archivePath << std::endl;
+
+        return true;
+    }
+} // vks
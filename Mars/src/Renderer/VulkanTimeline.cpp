@@ -0,0 +1,228 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#include "VulkanTimeline.hpp"
+
+namespace vks
+{
+    void QueueTimeline::initialise(VkDevice dev, VkQueue q, FencePool *fencePool, const TimelineFunctions &functions)
+    {
+        device = dev;
+        queue = q;
+        fences = fencePool;
+        fn = functions;
+        submitted = 0;
+        completed = 0;
+        semaphore = VK_NULL_HANDLE;
+
+        if (fn.waitSemaphores == nullptr || fn.getCounterValue == nullptr)
+            return;
+
+        VkSemaphoreTypeCreateInfoKHR typeInfo{};
+        typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+        typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+        typeInfo.initialValue = 0;
+
+        auto semaphoreInfo = Inits::semaphoreCreateInfo();
+        semaphoreInfo.pNext = &typeInfo;
+        vkCreateSemaphore(device, &semaphoreInfo, nullptr, &semaphore);
+    }
+
+    void QueueTimeline::shutdown()
+    {
+        wait(submitted);
+
+        if (semaphore != VK_NULL_HANDLE)
+            vkDestroySemaphore(device, semaphore, nullptr);
+
+        semaphore = VK_NULL_HANDLE;
+    }
+
+    uint64_t QueueTimeline::submit(const TimelineSubmitInfo &info)
+    {
+        constexpr uint32_t MaxWaits = TimelineSubmitInfo::MaxWaits + 1;
+
+        VkSemaphore waitSemaphores[MaxWaits];
+        uint64_t waitValues[MaxWaits];
+        VkPipelineStageFlags waitStages[MaxWaits];
+        uint32_t waitCount = 0;
+
+        for (uint32_t i = 0; i < info.waitCount; i++)
+        {
+            const auto &wait = info.waits[i];
+
+            if (wait.timeline->isComplete(wait.value))
+                continue;
+
+            if (native() && wait.timeline->native())
+            {
+                waitSemaphores[waitCount] = wait.timeline->semaphore;
+                waitValues[waitCount] = wait.value;
+                waitStages[waitCount] = wait.stage;
+                waitCount++;
+            }
+            else
+            {
+                // Fences cannot be waited on by the GPU, so the fallback chains on the CPU
+                wait.timeline->wait(wait.value);
+            }
+        }
+
+        if (info.binaryWait != VK_NULL_HANDLE)
+        {
+            waitSemaphores[waitCount] = info.binaryWait;
+            waitValues[waitCount] = 0;
+            waitStages[waitCount] = info.binaryWaitStage;
+            waitCount++;
+        }
+
+        VkSemaphore signalSemaphores[2];
+        uint64_t signalValues[2];
+        uint32_t signalCount = 0;
+
+        std::lock_guard lock(mutex);
+        const uint64_t value = submitted + 1;
+
+        if (native())
+        {
+            signalSemaphores[signalCount] = semaphore;
+            signalValues[signalCount] = value;
+            signalCount++;
+        }
+
+        if (info.binarySignal != VK_NULL_HANDLE)
+        {
+            signalSemaphores[signalCount] = info.binarySignal;
+            signalValues[signalCount] = 0;
+            signalCount++;
+        }
+
+        VkTimelineSemaphoreSubmitInfoKHR timelineInfo{};
+        timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+        timelineInfo.waitSemaphoreValueCount = waitCount;
+        timelineInfo.pWaitSemaphoreValues = waitValues;
+        timelineInfo.signalSemaphoreValueCount = signalCount;
+        timelineInfo.pSignalSemaphoreValues = signalValues;
+
+        auto submitInfo = Inits::submitInfo(info.pCommandBuffers, info.commandBufferCount);
+        submitInfo.pNext = native() ? &timelineInfo : nullptr;
+        submitInfo.waitSemaphoreCount = waitCount;
+        submitInfo.pWaitSemaphores = waitSemaphores;
+        submitInfo.pWaitDstStageMask = waitStages;
+        submitInfo.signalSemaphoreCount = signalCount;
+        submitInfo.pSignalSemaphores = signalSemaphores;
+
+        VkFence fence = VK_NULL_HANDLE;
+
+        if (!native())
+        {
+            fence = fences->acquire();
+            fenceValues.push_back({value, fence, 0});
+        }
+
+        vkQueueSubmit(queue, 1, &submitInfo, fence);
+        submitted = value;
+        return value;
+    }
+
+    VkResult QueueTimeline::present(const VkPresentInfoKHR &presentInfo)
+    {
+        std::lock_guard lock(mutex);
+        return vkQueuePresentKHR(queue, &presentInfo);
+    }
+
+    uint64_t QueueTimeline::completedValue()
+    {
+        if (native())
+        {
+            uint64_t value = 0;
+            fn.getCounterValue(device, semaphore, &value);
+            raiseCompleted(value);
+        }
+        else
+        {
+            std::lock_guard lock(mutex);
+            collectFences();
+        }
+
+        return completed;
+    }
+
+    void QueueTimeline::wait(uint64_t value)
+    {
+        if (value == 0 || isComplete(value))
+            return;
+
+        if (native())
+        {
+            VkSemaphoreWaitInfoKHR waitInfo{};
+            waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+            waitInfo.semaphoreCount = 1;
+            waitInfo.pSemaphores = &semaphore;
+            waitInfo.pValues = &value;
+            fn.waitSemaphores(device, &waitInfo, UINT64_MAX);
+            raiseCompleted(value);
+            return;
+        }
+
+        const auto findEntry = [&]() -> FenceValue* {
+            for (auto &entry : fenceValues)
+            {
+                if (entry.value >= value)
+                    return &entry;
+            }
+            return nullptr;
+        };
+
+        VkFence fence = VK_NULL_HANDLE;
+        {
+            std::lock_guard lock(mutex);
+
+            if (auto entry = findEntry())
+            {
+                // Keeps the fence from being recycled while we block on it outside the lock
+                entry->waiters++;
+                fence = entry->fence;
+            }
+        }
+
+        if (fence == VK_NULL_HANDLE)
+            return;
+
+        vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
+
+        std::lock_guard lock(mutex);
+
+        if (auto entry = findEntry())
+            entry->waiters--;
+
+        collectFences();
+    }
+
+    void QueueTimeline::collectFences()
+    {
+        // Submissions on a single queue retire in order
+        while (!fenceValues.empty())
+        {
+            auto &front = fenceValues.front();
+
+            if (vkGetFenceStatus(device, front.fence) != VK_SUCCESS)
+                break;
+
+            raiseCompleted(front.value);
+
+            if (front.waiters > 0)
+                break;
+
+            fences->recycle(front.fence);
+            fenceValues.pop_front();
+        }
+    }
+
+    void QueueTimeline::raiseCompleted(uint64_t value)
+    {
+        auto previous = completed.load();
+        while (previous < value && !completed.compare_exchange_weak(previous, value));
+    }
+} // vks
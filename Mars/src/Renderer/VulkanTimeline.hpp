@@ -0,0 +1,85 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#pragma once
+
+#include "VulkanCommandPools.hpp"
+
+namespace vks
+{
+    class QueueTimeline;
+
+    struct TimelineFunctions
+    {
+        PFN_vkWaitSemaphoresKHR             waitSemaphores;
+        PFN_vkGetSemaphoreCounterValueKHR   getCounterValue;
+    };
+
+    struct TimelineWait
+    {
+        QueueTimeline           *timeline;
+        uint64_t                value;
+        VkPipelineStageFlags    stage;
+    };
+
+    struct TimelineSubmitInfo
+    {
+        static constexpr uint32_t MaxWaits = 4;
+
+        const VkCommandBuffer   *pCommandBuffers;
+        uint32_t                commandBufferCount;
+        TimelineWait            waits[MaxWaits];
+        uint32_t                waitCount;
+
+        // Binary semaphores are only kept where the swapchain requires them
+        VkSemaphore             binaryWait;
+        VkPipelineStageFlags    binaryWaitStage;
+        VkSemaphore             binarySignal;
+    };
+
+    // A single monotonically increasing counter per queue. Every submission signals the next value,
+    // so the CPU can wait on any earlier submission and other queues can chain on it on the GPU.
+    // Backed by VK_KHR_timeline_semaphore, or by one pooled fence per value when it is unavailable.
+    class QueueTimeline
+    {
+        struct FenceValue
+        {
+            uint64_t    value;
+            VkFence     fence;
+            uint32_t    waiters;
+        };
+
+    public:
+        void initialise(VkDevice dev, VkQueue q, FencePool *fencePool, const TimelineFunctions &functions);
+        void shutdown();
+
+        uint64_t submit(const TimelineSubmitInfo &info);
+        VkResult present(const VkPresentInfoKHR &presentInfo);
+        uint64_t completedValue();
+        void wait(uint64_t value);
+
+        bool isComplete(uint64_t value)
+        {
+            return value <= completed || value <= completedValue();
+        }
+
+        uint64_t lastSubmitted() const { return submitted; }
+        bool native() const { return semaphore != VK_NULL_HANDLE; }
+        VkQueue getQueue() const { return queue; }
+
+    private:
+        void collectFences();
+        void raiseCompleted(uint64_t value);
+
+        VkDevice                    device;
+        VkQueue                     queue;
+        VkSemaphore                 semaphore;
+        FencePool                   *fences;
+        TimelineFunctions           fn;
+        std::atomic<uint64_t>       submitted;
+        std::atomic<uint64_t>       completed;
+        std::deque<FenceValue>      fenceValues;
+        std::mutex                  mutex;
+    };
+} // vks
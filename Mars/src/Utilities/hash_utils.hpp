@@ -0,0 +1,26 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+// FNV-1a, stable across runs and platforms so hashes can be written to disk
+inline uint64_t HashBytes(const void *data, size_t size, uint64_t seed = FNV_OFFSET_BASIS)
+{
+    auto bytes = static_cast<const uint8_t*>(data);
+    uint64_t hash = seed;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
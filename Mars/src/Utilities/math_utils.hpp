@@ -5,6 +5,8 @@
 #pragma once
 
 #include <stdint.h>
+#include <stddef.h>
+#include <cmath>
 
 constexpr float PI32 = 3.141592741f;
 constexpr double PI64 = 3.141592653589793;
@@ -0,0 +1,44 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#include "../src/Renderer/VulkanShaderLibrary.hpp"
+
+#include <algorithm>
+#include <filesystem>
+
+// Packs every .spv file of a directory into one archive for vks::ShaderLibrary
+//  ShaderPacker <archive> <spirv directory>
+int main(int argc, char **argv)
+{
+    if (argc != 3)
+    {
+        std::cout << "Usage: ShaderPacker <archive> <spirv directory>" << std::endl;
+        return 1;
+    }
+
+    const auto archivePath = std::filesystem::absolute(argv[1]).string();
+
+    // Ids hash the paths handed to pack, relative names keep them independent of the build directory
+    std::error_code error;
+    std::filesystem::current_path(argv[2], error);
+
+    if (error)
+    {
+        std::cout << "Error, could not enter " << argv[2] << ": " << error.message() << std::endl;
+        return 1;
+    }
+
+    auto files = std::vector<std::string>();
+
+    for (const auto &entry : std::filesystem::directory_iterator("."))
+    {
+        if (entry.is_regular_file() && entry.path().extension() == ".spv")
+            files.push_back(entry.path().filename().string());
+    }
+
+    // Directory order is unspecified, sorting keeps the archive reproducible
+    std::sort(files.begin(), files.end());
+
+    return vks::ShaderLibrary::pack(archivePath.c_str(), files) ? 0 : 1;
+}
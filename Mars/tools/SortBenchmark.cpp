@@ -0,0 +1,130 @@
+//
+// Created by arlev on 19.10.2026.
+//
+
+#include "../src/Core/RadixSort.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+
+// Times Mars::RadixSorter against std::sort at 10k, 100k and 1M keys, single threaded and on a job system,
+// and checks both results against std::stable_sort. Exits with 1 on any mismatch.
+//  SortBenchmark [repetitions]
+
+using namespace Mars;
+
+enum class KeySet
+{
+    Random,     // Every bit varies, no pass can be skipped
+    DrawKeys    // Renderer3D's layout: a few pipelines, materials and meshes over a 16 bit depth
+};
+
+static std::vector<SortKey> MakeKeys(KeySet set, size_t count, std::mt19937_64 &random)
+{
+    auto keys = std::vector<SortKey>(count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        auto key = random();
+
+        // pass (4) | pipeline (12) | material (16) | mesh (16) | depth (16) as in DrawKey, all in pass 0
+        if (set == KeySet::DrawKeys)
+        {
+            const auto pipeline = key % 8;
+            const auto material = (key >> 8) % 64;
+            const auto mesh = (key >> 16) % 256;
+            const auto depth = (key >> 32) & 0xFFFF;
+            key = pipeline << 48 | material << 32 | mesh << 16 | depth;
+        }
+
+        keys[i] = { key, uint32_t(i) };
+    }
+
+    return keys;
+}
+
+static bool SameOrder(const std::vector<SortKey> &a, const std::vector<SortKey> &b)
+{
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const SortKey &x, const SortKey &y){
+        return x.key == y.key && x.index == y.index;
+    });
+}
+
+// Best of repetitions, each run on a fresh copy of keys. The last result is left in sorted.
+template<typename F>
+static double Time(const std::vector<SortKey> &keys, uint32_t repetitions, std::vector<SortKey> &sorted, F &&sort)
+{
+    double best = 0.0;
+
+    for (uint32_t i = 0; i < repetitions; i++)
+    {
+        sorted = keys;
+
+        const auto start = std::chrono::steady_clock::now();
+        sort(sorted);
+        const auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        best = i == 0 ? ms : min(best, ms);
+    }
+
+    return best;
+}
+
+int main(int argc, char **argv)
+{
+    const auto repetitions = argc > 1 ? uint32_t(max(std::atoi(argv[1]), 1)) : 5u;
+
+    JobSystem jobs;
+    jobs.initialise();
+
+    RadixSorter serial;
+    serial.initialise();
+
+    RadixSorter parallel;
+    parallel.initialise(&jobs);
+
+    std::cout << "Radix sort, best of " << repetitions << ", " << jobs.workerCount() << " workers" << std::endl;
+
+    auto random = std::mt19937_64(7);
+    bool matches = true;
+
+    for (const size_t count : { size_t(10000), size_t(100000), size_t(1000000) })
+    {
+        for (const auto set : { KeySet::Random, KeySet::DrawKeys })
+        {
+            const auto keys = MakeKeys(set, count, random);
+
+            auto reference = keys;
+            std::stable_sort(reference.begin(), reference.end(), [](const SortKey &a, const SortKey &b){ return a.key < b.key; });
+
+            std::vector<SortKey> sorted;
+
+            const auto comparisonMs = Time(keys, repetitions, sorted, [](std::vector<SortKey> &v){
+                std::sort(v.begin(), v.end(), [](const SortKey &a, const SortKey &b){ return a.key < b.key; });
+            });
+
+            const auto serialMs = Time(keys, repetitions, sorted, [&serial](std::vector<SortKey> &v){ serial.sort(v); });
+            const bool serialMatches = SameOrder(sorted, reference);
+
+            const auto parallelMs = Time(keys, repetitions, sorted, [&parallel](std::vector<SortKey> &v){ parallel.sort(v); });
+            const bool parallelMatches = SameOrder(sorted, reference);
+
+            const auto &stats = parallel.getStats();
+
+            std::cout << count << (set == KeySet::Random ? " random keys" : " draw keys")
+                      << ": std::sort " << comparisonMs << " ms, serial " << serialMs << " ms, parallel " << parallelMs
+                      << " ms (" << stats.passes << " passes, " << stats.skippedPasses << " skipped, " << stats.tasks << " tasks)";
+
+            if (!serialMatches || !parallelMatches)
+                std::cout << ", MISMATCH in " << (serialMatches ? "parallel" : parallelMatches ? "serial" : "both");
+
+            std::cout << std::endl;
+            matches = matches && serialMatches && parallelMatches;
+        }
+    }
+
+    jobs.shutdown();
+    return matches ? 0 : 1;
+}
@@ -1,10 +1,215 @@
 #include <Mars.hpp>
 
+#include <cstdlib>
+#include <cstring>
+
+// Stress scenes, picked by the MARS_SCENE environment variable:
+//  sprites     1M quads bouncing around the window, all submitted through Renderer2D every frame
+//  gpuscene    100k cubes in a GpuScene under an orbiting camera, 1% of them moved every frame
+class Sandbox : public Mars::Application
+{
+    struct Sprite
+    {
+        vec2<float> position;
+        vec2<float> velocity;
+        uint32_t    colour;
+    };
+
+public:
+    static constexpr uint32_t SpriteCount = 1000000;
+    static constexpr uint32_t GridSize = 50;            // Cubes per axis of the scene's grid, 40 layers high
+    static constexpr uint32_t GridLayers = 40;
+    static constexpr uint32_t MovedPerFrame = GridSize * GridSize * GridLayers / 100;
+    static constexpr float StatsInterval = 1.0f;     // Seconds between printed stats
+
+    explicit Sandbox(const Mars::ApplicationSpecifications &specs): Application(specs),
+        width(float(specs.width)), height(float(specs.height)), seed(0x9E3779B9), elapsed(0.0f), frames(0),
+        time(0.0f), nextMoved(0)
+    {
+        const auto scene = std::getenv("MARS_SCENE");
+
+        if (scene != nullptr && std::strcmp(scene, "sprites") == 0)
+            createSprites();
+        else if (scene != nullptr && std::strcmp(scene, "gpuscene") == 0)
+            createObjects();
+    }
+
+protected:
+    void onUpdate(float timestep) override
+    {
+        if (!sprites.empty())
+            updateSprites(timestep);
+
+        if (!objects.empty())
+            updateObjects(timestep);
+
+        elapsed += timestep;
+        frames++;
+
+        if (elapsed >= StatsInterval)
+        {
+            printStats();
+            elapsed = 0.0f;
+            frames = 0;
+        }
+    }
+
+private:
+    void createSprites()
+    {
+        sprites.resize(SpriteCount);
+
+        for (auto &sprite : sprites)
+        {
+            sprite.position = vec2<float>(nextRandom() * width, nextRandom() * height);
+            sprite.velocity = vec2<float>(nextRandom() * 200.0f - 100.0f, nextRandom() * 200.0f - 100.0f);
+            sprite.colour = Mars::Renderer2D::packColour(vec4<float>(nextRandom(), nextRandom(), nextRandom(), 1.0f));
+        }
+
+        std::cout << "Sprite scene, " << SpriteCount << " quads" << std::endl;
+    }
+
+    void updateSprites(float timestep)
+    {
+        auto &renderer = Mars::Renderer::Get2D();
+        const auto size = vec2<float>(4.0f, 4.0f);
+
+        for (auto &sprite : sprites)
+        {
+            sprite.position += sprite.velocity * timestep;
+
+            if (sprite.position.x < 0.0f || sprite.position.x > width)
+                sprite.velocity.x = -sprite.velocity.x;
+
+            if (sprite.position.y < 0.0f || sprite.position.y > height)
+                sprite.velocity.y = -sprite.velocity.y;
+
+            renderer.drawQuad(sprite.position, size, sprite.colour);
+        }
+    }
+
+    void createObjects()
+    {
+        if (!Mars::Renderer::InitGpuScene(GridSize * GridSize * GridLayers))
+            return;
+
+        // Unit cube, four vertices per face so every face keeps its own normal
+        constexpr float Faces[6][3] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+        Mars::SceneVertex vertices[24];
+        uint32_t indices[36];
+
+        for (uint32_t face = 0; face < 6; face++)
+        {
+            const auto normal = vec3<float>(Faces[face][0], Faces[face][1], Faces[face][2]);
+            const auto tangent = face < 2 ? vec3<float>(0.0f, 1.0f, 0.0f) : vec3<float>(1.0f, 0.0f, 0.0f);
+            const auto bitangent = cross(normal, tangent);
+            const float corners[4][2] = { { -1, -1 }, { 1, -1 }, { 1, 1 }, { -1, 1 } };
+
+            for (uint32_t corner = 0; corner < 4; corner++)
+            {
+                const auto position = (normal + tangent * corners[corner][0] + bitangent * corners[corner][1]) * 0.5f;
+                vertices[face * 4 + corner] = { { position.x, position.y, position.z }, { normal.x, normal.y, normal.z } };
+            }
+
+            const uint32_t quad[] = { 0, 1, 2, 2, 3, 0 };
+
+            for (uint32_t i = 0; i < 6; i++)
+                indices[face * 6 + i] = face * 4 + quad[i];
+        }
+
+        auto &renderer = Mars::Renderer::GetGpuScene();
+        const auto cube = renderer.addMesh(vertices, 24, indices, 36);
+
+        for (uint32_t y = 0; y < GridLayers; y++)
+        {
+            for (uint32_t z = 0; z < GridSize; z++)
+            {
+                for (uint32_t x = 0; x < GridSize; x++)
+                {
+                    const auto position = gridPosition(x, y, z);
+                    objects.push_back(renderer.getScene().addObject(cube, 0, mat4x4::translate(position)));
+                    origins.push_back(position);
+                }
+            }
+        }
+
+        std::cout << "GPU scene, " << objects.size() << " cubes" << std::endl;
+    }
+
+    void updateObjects(float timestep)
+    {
+        auto &renderer = Mars::Renderer::GetGpuScene();
+        time += timestep;
+
+        // A rolling window of objects bobs up and down, the rest stay untouched and are never uploaded
+        for (uint32_t i = 0; i < MovedPerFrame; i++)
+        {
+            const auto object = nextMoved;
+            const auto offset = vec3<float>(0.0f, 0.5f * std::sin(time + float(object)), 0.0f);
+            renderer.getScene().setTransform(objects[object], mat4x4::translate(origins[object] + offset));
+            nextMoved = (nextMoved + 1) % uint32_t(objects.size());
+        }
+
+        const auto eye = vec3<float>(120.0f * std::cos(0.2f * time), 80.0f, 120.0f * std::sin(0.2f * time));
+        const auto view = mat4x4::lookAt(eye, vec3<float>(0.0f), vec3<float>(0.0f, 1.0f, 0.0f));
+        const auto projection = mat4x4::perspective(1.0f, width / height, 0.1f, 500.0f);
+        renderer.setCamera(projection * view);
+    }
+
+    static vec3<float> gridPosition(uint32_t x, uint32_t y, uint32_t z)
+    {
+        constexpr float Spacing = 2.0f;
+        const auto centre = float(GridSize - 1) * 0.5f;
+        return vec3<float>((float(x) - centre) * Spacing, float(y) * Spacing, (float(z) - centre) * Spacing);
+    }
+
+    void printStats()
+    {
+        const auto frameMs = 1000.0f * elapsed / float(frames);
+
+        if (!sprites.empty())
+        {
+            const auto &stats = Mars::Renderer::Get2D().getStats();
+            std::cout << frameMs << " ms/frame, " << stats.quads << " quads in " << stats.drawCalls
+                      << " draws, " << stats.submitMs << " ms submit" << std::endl;
+        }
+        else if (!objects.empty())
+        {
+            const auto &stats = Mars::Renderer::GetGpuScene().getScene().getStats();
+            std::cout << frameMs << " ms/frame, " << stats.objects << " objects, " << stats.uploads
+                      << " uploaded, " << stats.recordMs << " ms recording" << std::endl;
+        }
+        else
+        {
+            std::cout << frameMs << " ms/frame" << std::endl;
+        }
+    }
+
+    // 0 to 1, xorshift so scenes are the same every run
+    float nextRandom()
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return float(seed >> 8) / float(1u << 24);
+    }
+
+    std::vector<Sprite>         sprites;
+    std::vector<uint32_t>       objects;        // GpuScene object handles
+    std::vector<vec3<float>>    origins;
+    float                       width, height;
+    uint32_t                    seed;
+    float                       elapsed;
+    uint32_t                    frames;
+    float                       time;
+    uint32_t                    nextMoved;
+};
+
 Mars::Application *Mars::CreateApplication()
 {
     Mars::ApplicationSpecifications specs;
     specs.name = "Sandbox";
     specs.width = 1280;
     specs.height = 720;
-    return new Application(specs);
-};
\ No newline at end of file
+    return new Sandbox(specs);
+};